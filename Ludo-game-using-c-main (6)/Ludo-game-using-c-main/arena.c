@@ -0,0 +1,364 @@
+#define _GNU_SOURCE
+
+#include "arena.h"
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define SMALL_PAGE_SIZE 4096
+#define MPOL_PREFERRED 1
+
+static const char *pageModeNames[] = {"small", "thp", "huge"};
+
+const char *getPageModeName(PageMode pages)
+{
+    return pageModeNames[pages];
+}
+
+bool parsePageMode(const char *name, PageMode *pages)
+{
+    for (int i = 0; i < (int)(sizeof(pageModeNames) / sizeof(pageModeNames[0])); i++)
+    {
+        if (strcmp(pageModeNames[i], name) == 0)
+        {
+            *pages = (PageMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static size_t roundUp(size_t value, size_t unit)
+{
+    return (value + unit - 1) / unit * unit;
+}
+
+// Over-maps by one huge page and trims both ends, leaving a mapping that the
+// kernel can back with huge pages from its first byte
+static void *mapAligned(size_t size)
+{
+    size_t padded = size + HUGE_PAGE_SIZE;
+    unsigned char *raw = mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    unsigned char *aligned = (unsigned char *)roundUp((uintptr_t)raw, HUGE_PAGE_SIZE);
+    if (aligned > raw)
+    {
+        munmap(raw, aligned - raw);
+    }
+    size_t tail = (raw + padded) - (aligned + size);
+    if (tail > 0)
+    {
+        munmap(aligned + size, tail);
+    }
+    return aligned;
+}
+
+// Best effort: containers often refuse mbind, and first touch from a pinned
+// thread places the pages just the same
+static void preferNode(void *base, size_t size, int memoryNode)
+{
+#ifdef SYS_mbind
+    if (memoryNode >= 0 && memoryNode < MAX_NODES)
+    {
+        unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long)) + 1] = {0};
+        mask[memoryNode / (8 * sizeof(unsigned long))] = 1UL << (memoryNode % (8 * sizeof(unsigned long)));
+        syscall(SYS_mbind, base, size, MPOL_PREFERRED, mask, (unsigned long)MAX_NODES + 1, 0);
+    }
+#else
+    (void)base;
+    (void)size;
+    (void)memoryNode;
+#endif
+}
+
+bool createArena(Arena *arena, size_t size, PageMode pages, int memoryNode)
+{
+    memset(arena, 0, sizeof(*arena));
+    void *base = NULL;
+
+    if (pages == PAGES_SMALL)
+    {
+        size = roundUp(size, SMALL_PAGE_SIZE);
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED)
+        {
+            base = NULL;
+        }
+#ifdef MADV_NOHUGEPAGE
+        if (base != NULL)
+        {
+            madvise(base, size, MADV_NOHUGEPAGE);
+        }
+#endif
+    }
+    else
+    {
+        size = roundUp(size, HUGE_PAGE_SIZE);
+#ifdef MAP_HUGETLB
+        if (pages == PAGES_EXPLICIT)
+        {
+            base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (base == MAP_FAILED)
+            {
+                base = NULL;
+            }
+        }
+#endif
+        if (base == NULL)
+        {
+            // No reserved huge pages: fall back to transparent ones
+            pages = PAGES_TRANSPARENT;
+            base = mapAligned(size);
+#ifdef MADV_HUGEPAGE
+            if (base != NULL && madvise(base, size, MADV_HUGEPAGE) != 0)
+            {
+                pages = PAGES_SMALL;
+            }
+#else
+            pages = PAGES_SMALL;
+#endif
+        }
+    }
+
+    if (base == NULL)
+    {
+        perror("Failed to map arena");
+        return false;
+    }
+
+    preferNode(base, size, memoryNode);
+
+    // First touch decides where each page lives
+    for (size_t offset = 0; offset < size; offset += SMALL_PAGE_SIZE)
+    {
+        ((volatile unsigned char *)base)[offset] = 0;
+    }
+
+    arena->base = base;
+    arena->size = size;
+    arena->pages = pages;
+    return true;
+}
+
+void *arenaAlloc(Arena *arena, size_t size, size_t align)
+{
+    size_t start = roundUp(arena->used, align);
+    if (start > arena->size || size > arena->size - start)
+    {
+        return NULL;
+    }
+    arena->used = start + size;
+    return arena->base + start;
+}
+
+size_t arenaHugeBytes(const Arena *arena)
+{
+    FILE *smaps = fopen("/proc/self/smaps", "r");
+    if (smaps == NULL)
+    {
+        return 0;
+    }
+
+    uintptr_t first = (uintptr_t)arena->base;
+    uintptr_t last = first + arena->size;
+    bool inside = false;
+    size_t hugeBytes = 0;
+    char line[512];
+
+    while (fgets(line, sizeof(line), smaps) != NULL)
+    {
+        unsigned long start, end, kilobytes;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+        {
+            inside = start < last && end > first;
+        }
+        else if (inside && (sscanf(line, "AnonHugePages: %lu kB", &kilobytes) == 1 ||
+                            sscanf(line, "Private_Hugetlb: %lu kB", &kilobytes) == 1))
+        {
+            hugeBytes += kilobytes * 1024;
+        }
+    }
+    fclose(smaps);
+    return hugeBytes;
+}
+
+void destroyArena(Arena *arena)
+{
+    if (arena->base != NULL)
+    {
+        munmap(arena->base, arena->size);
+    }
+    memset(arena, 0, sizeof(*arena));
+}
+
+static void addCpu(unsigned long long *cpus, int cpu)
+{
+    if (cpu >= 0 && cpu < MAX_CPUS)
+    {
+        cpus[cpu / 64] |= 1ULL << (cpu % 64);
+    }
+}
+
+static bool hasCpu(const unsigned long long *cpus, int cpu)
+{
+    return (cpus[cpu / 64] >> (cpu % 64) & 1) != 0;
+}
+
+static int countCpus(const unsigned long long *cpus)
+{
+    int count = 0;
+    for (int i = 0; i < CPU_MASK_WORDS; i++)
+    {
+        count += __builtin_popcountll(cpus[i]);
+    }
+    return count;
+}
+
+// Parses a kernel CPU list such as "0-3,8-11"
+static bool readCpuList(const char *path, unsigned long long *cpus)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    char text[4096];
+    bool read = fgets(text, sizeof(text), file) != NULL;
+    fclose(file);
+    if (!read)
+    {
+        return false;
+    }
+
+    char *cursor = text;
+    while (*cursor != '\0' && *cursor != '\n')
+    {
+        char *end;
+        long low = strtol(cursor, &end, 10);
+        long high = low;
+        if (end == cursor)
+        {
+            break;
+        }
+        if (*end == '-')
+        {
+            cursor = end + 1;
+            high = strtol(cursor, &end, 10);
+        }
+        for (long cpu = low; cpu <= high; cpu++)
+        {
+            addCpu(cpus, (int)cpu);
+        }
+        cursor = *end == ',' ? end + 1 : end;
+    }
+    return true;
+}
+
+bool loadNodeLayout(NodeLayout *layout, int wantNodes)
+{
+    memset(layout, 0, sizeof(*layout));
+
+    // The machine's own nodes, or one node holding every processor when the
+    // kernel does not say
+    NodeLayout real;
+    memset(&real, 0, sizeof(real));
+    for (int node = 0; node < MAX_NODES; node++)
+    {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        if (!readCpuList(path, real.cpus[real.nodeCount]) || countCpus(real.cpus[real.nodeCount]) == 0)
+        {
+            // Missing, or memory without processors
+            memset(real.cpus[real.nodeCount], 0, sizeof(real.cpus[real.nodeCount]));
+            continue;
+        }
+        real.memoryNode[real.nodeCount++] = node;
+    }
+    if (real.nodeCount == 0)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < (processors > 0 ? processors : 1); cpu++)
+        {
+            addCpu(real.cpus[0], (int)cpu);
+        }
+        real.memoryNode[0] = -1;
+        real.nodeCount = 1;
+    }
+
+    if (wantNodes <= 0 || wantNodes == real.nodeCount)
+    {
+        *layout = real;
+        return true;
+    }
+    if (wantNodes > MAX_NODES)
+    {
+        fprintf(stderr, "At most %d nodes are supported.\n", MAX_NODES);
+        return false;
+    }
+
+    // Deal the processors out to the requested nodes in order; with fewer
+    // processors than nodes, nodes share them
+    int cpuList[MAX_CPUS];
+    int cpuNode[MAX_CPUS];
+    int cpuCount = 0;
+    for (int node = 0; node < real.nodeCount; node++)
+    {
+        for (int cpu = 0; cpu < MAX_CPUS; cpu++)
+        {
+            if (hasCpu(real.cpus[node], cpu))
+            {
+                cpuList[cpuCount] = cpu;
+                cpuNode[cpuCount++] = real.memoryNode[node];
+            }
+        }
+    }
+    if (cpuCount == 0)
+    {
+        fprintf(stderr, "No processors found.\n");
+        return false;
+    }
+
+    layout->nodeCount = wantNodes;
+    layout->simulated = true;
+    int perNode = cpuCount >= wantNodes ? cpuCount / wantNodes : 1;
+    for (int node = 0; node < wantNodes; node++)
+    {
+        int firstCpu = cpuCount >= wantNodes ? node * perNode : node % cpuCount;
+        int lastCpu = cpuCount >= wantNodes && node == wantNodes - 1 ? cpuCount : firstCpu + perNode;
+        for (int i = firstCpu; i < lastCpu; i++)
+        {
+            addCpu(layout->cpus[node], cpuList[i]);
+        }
+        layout->memoryNode[node] = cpuNode[firstCpu];
+    }
+    return true;
+}
+
+bool pinToNode(const NodeLayout *layout, int node)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < MAX_CPUS && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (hasCpu(layout->cpus[node], cpu))
+        {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+    {
+        perror("Failed to pin worker to its node");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+#define MAX_NODES 64
+#define MAX_CPUS 1024
+#define CPU_MASK_WORDS (MAX_CPUS / 64)
+
+typedef enum
+{
+    PAGES_SMALL,       // base pages only, transparent huge pages turned off
+    PAGES_TRANSPARENT, // madvise(MADV_HUGEPAGE) on a huge-page aligned mapping
+    PAGES_EXPLICIT     // MAP_HUGETLB from the reserved pool, else transparent
+} PageMode;
+
+// One mapping, carved up by bumping a pointer. Nothing is freed on its own:
+// the owner reuses what it carved and drops the whole arena at the end.
+typedef struct
+{
+    unsigned char *base;
+    size_t size;
+    size_t used;
+    PageMode pages; // what the mapping actually got
+} Arena;
+
+// CPUs of each memory node. Asking for more nodes than the machine has
+// splits its processors into simulated nodes, so that pinning and
+// node-local arenas can be exercised on a single socket.
+typedef struct
+{
+    int nodeCount;
+    bool simulated;
+    int memoryNode[MAX_NODES]; // real node whose memory a node uses
+    unsigned long long cpus[MAX_NODES][CPU_MASK_WORDS];
+} NodeLayout;
+
+const char *getPageModeName(PageMode pages);
+bool parsePageMode(const char *name, PageMode *pages);
+
+// Maps at least size bytes and touches every page from the calling thread,
+// so with the thread pinned first the memory lands on its node. memoryNode
+// is also requested from the kernel explicitly, -1 leaves it to first touch.
+bool createArena(Arena *arena, size_t size, PageMode pages, int memoryNode);
+void *arenaAlloc(Arena *arena, size_t size, size_t align); // NULL when full
+size_t arenaHugeBytes(const Arena *arena);                 // bytes backed by huge pages right now
+void destroyArena(Arena *arena);
+
+bool loadNodeLayout(NodeLayout *layout, int wantNodes); // 0 takes the machine's own nodes
+bool pinToNode(const NodeLayout *layout, int node);
+
+#endif // ARENA_H
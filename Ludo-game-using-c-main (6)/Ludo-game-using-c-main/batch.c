@@ -0,0 +1,401 @@
+#define _GNU_SOURCE
+
+#include "batch.h"
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Games a worker takes from the shared counter at a time
+#define CLAIM_GAMES 64
+#define CACHE_LINE 64
+
+typedef struct
+{
+    GameState game;
+    RunawayDetector detector;
+    GameRecord record;
+} GameSlot;
+
+typedef struct
+{
+    const SimConfig *config;
+    const BatchConfig *batch;
+    const NodeLayout *layout;
+    unsigned long long endGame;
+    GameRecord *records; // indexed from the first game, NULL unless records are kept
+    unsigned long long firstGame;
+
+    pthread_mutex_t lock;
+    unsigned long long nextGame;
+} BatchShared;
+
+typedef struct
+{
+    BatchShared *shared;
+    pthread_t thread;
+    int node;
+    bool ok;
+    SimStats stats; // copied out of the arena when the worker is done
+    unsigned long long turns;
+    PageMode pages;
+    size_t arenaBytes;
+    size_t hugeBytes;
+
+    unsigned long long claimNext; // games claimed but not started yet
+    unsigned long long claimEnd;
+} BatchWorker;
+
+void initBatchConfig(BatchConfig *config)
+{
+    config->threads = 0;
+    config->nodes = 0;
+    config->gamesInFlight = DEFAULT_GAMES_IN_FLIGHT;
+    config->pages = PAGES_EXPLICIT;
+}
+
+static double currentTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static bool claimGame(BatchWorker *worker, unsigned long long *gameIndex)
+{
+    if (worker->claimNext == worker->claimEnd)
+    {
+        BatchShared *shared = worker->shared;
+        pthread_mutex_lock(&shared->lock);
+        worker->claimNext = shared->nextGame;
+        worker->claimEnd = shared->endGame - worker->claimNext > CLAIM_GAMES ? worker->claimNext + CLAIM_GAMES
+                                                                            : shared->endGame;
+        shared->nextGame = worker->claimEnd;
+        pthread_mutex_unlock(&shared->lock);
+    }
+    if (worker->claimNext == worker->claimEnd)
+    {
+        return false;
+    }
+    *gameIndex = worker->claimNext++;
+    return true;
+}
+
+static size_t workerArenaSize(const BatchShared *shared)
+{
+    size_t perSlot = sizeof(GameSlot) + runawayStorageSize(&shared->config->limits) + 2 * CACHE_LINE;
+    return sizeof(SimStats) + CACHE_LINE + shared->batch->gamesInFlight * perSlot;
+}
+
+// Steps every game in flight by one turn per pass. A finished game hands its
+// slot, detector tables included, straight to the next game.
+static void playInFlight(BatchWorker *worker, GameSlot *slots, SimStats *stats)
+{
+    BatchShared *shared = worker->shared;
+    int active = 0;
+    unsigned long long gameIndex;
+
+    while (active < shared->batch->gamesInFlight && claimGame(worker, &gameIndex))
+    {
+        startSimulatedGame(shared->config, &slots[active].detector, gameIndex, &slots[active].game,
+                           &slots[active].record);
+        active++;
+    }
+
+    while (active > 0)
+    {
+        for (int i = 0; i < active;)
+        {
+            GameSlot *slot = &slots[i];
+            worker->turns++;
+            if (!stepSimulatedGame(&slot->game, &slot->detector, &slot->record))
+            {
+                i++;
+                continue;
+            }
+
+            int captures[NUM_PLAYERS];
+            countCaptures(&slot->game, captures);
+            addGameToStats(stats, &slot->record, captures);
+            if (shared->records != NULL)
+            {
+                shared->records[slot->record.gameIndex - shared->firstGame] = slot->record;
+            }
+
+            if (claimGame(worker, &gameIndex))
+            {
+                startSimulatedGame(shared->config, &slot->detector, gameIndex, &slot->game, &slot->record);
+                i++;
+            }
+            else
+            {
+                // Swap rather than copy, so every slot keeps its own detector tables
+                GameSlot last = slots[--active];
+                slots[active] = *slot;
+                *slot = last;
+            }
+        }
+    }
+}
+
+static void *batchWorker(void *argument)
+{
+    BatchWorker *worker = argument;
+    BatchShared *shared = worker->shared;
+    int inFlight = shared->batch->gamesInFlight;
+
+    // Pin before the arena is touched, so its pages land on this node
+    if (!pinToNode(shared->layout, worker->node))
+    {
+        return NULL;
+    }
+
+    Arena arena;
+    if (!createArena(&arena, workerArenaSize(shared), shared->batch->pages, shared->layout->memoryNode[worker->node]))
+    {
+        return NULL;
+    }
+
+    SimStats *stats = arenaAlloc(&arena, sizeof(SimStats), CACHE_LINE);
+    GameSlot *slots = arenaAlloc(&arena, inFlight * sizeof(GameSlot), CACHE_LINE);
+    size_t detectorBytes = runawayStorageSize(&shared->config->limits);
+    for (int i = 0; i < inFlight && slots != NULL; i++)
+    {
+        void *storage = detectorBytes > 0 ? arenaAlloc(&arena, detectorBytes, CACHE_LINE) : NULL;
+        if (detectorBytes > 0 && storage == NULL)
+        {
+            slots = NULL;
+            break;
+        }
+        initRunawayDetectorIn(&slots[i].detector, &shared->config->limits, storage);
+    }
+    if (stats == NULL || slots == NULL)
+    {
+        fprintf(stderr, "Worker arena is too small.\n");
+        destroyArena(&arena);
+        return NULL;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    playInFlight(worker, slots, stats);
+
+    worker->stats = *stats;
+    worker->pages = arena.pages;
+    worker->arenaBytes = arena.size;
+    worker->hugeBytes = arenaHugeBytes(&arena);
+    worker->ok = true;
+    destroyArena(&arena);
+    return NULL;
+}
+
+bool runBatch(const SimConfig *config, unsigned long long firstGame, unsigned long long gameCount,
+              const BatchConfig *batch, SimResult *result, BatchReport *report)
+{
+    memset(result, 0, sizeof(*result));
+    memset(report, 0, sizeof(*report));
+    result->config = *config;
+    result->firstGame = firstGame;
+    result->gameCount = gameCount;
+
+    NodeLayout layout;
+    if (batch->gamesInFlight <= 0 || !loadNodeLayout(&layout, batch->nodes))
+    {
+        return false;
+    }
+    int threads = batch->threads > 0 ? batch->threads : layout.nodeCount;
+
+    if (config->keepRecords && gameCount > 0)
+    {
+        result->records = malloc(gameCount * sizeof(GameRecord));
+        if (result->records == NULL)
+        {
+            perror("Failed to allocate game records");
+            return false;
+        }
+        result->recordCount = gameCount;
+    }
+
+    BatchShared shared;
+    shared.config = config;
+    shared.batch = batch;
+    shared.layout = &layout;
+    shared.firstGame = firstGame;
+    shared.endGame = firstGame + gameCount;
+    shared.records = result->records;
+    shared.nextGame = firstGame;
+    pthread_mutex_init(&shared.lock, NULL);
+
+    BatchWorker *workers = calloc(threads, sizeof(BatchWorker));
+    if (workers == NULL)
+    {
+        perror("Failed to allocate workers");
+        freeSimResult(result);
+        return false;
+    }
+
+    bool logWasEnabled = gameLogEnabled;
+    gameLogEnabled = false;
+    double started = currentTime();
+
+    int running = 0;
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].shared = &shared;
+        workers[i].node = i % layout.nodeCount;
+        if (pthread_create(&workers[i].thread, NULL, batchWorker, &workers[i]) != 0)
+        {
+            perror("Failed to start worker");
+            break;
+        }
+        running++;
+    }
+
+    bool ok = running == threads;
+    report->pages = batch->pages;
+    for (int i = 0; i < running; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        ok = ok && workers[i].ok;
+        mergeSimStats(&result->stats, &workers[i].stats);
+        report->turns += workers[i].turns;
+        report->hugeBytes += workers[i].hugeBytes;
+        report->arenaBytes = workers[i].arenaBytes;
+        if (workers[i].pages < report->pages)
+        {
+            report->pages = workers[i].pages;
+        }
+    }
+
+    report->seconds = currentTime() - started;
+    report->threads = threads;
+    report->nodes = layout.nodeCount;
+    report->simulatedNodes = layout.simulated;
+    gameLogEnabled = logWasEnabled;
+
+    pthread_mutex_destroy(&shared.lock);
+    free(workers);
+    if (!ok)
+    {
+        freeSimResult(result);
+    }
+    return ok;
+}
+
+// dTLB load misses of this thread and the workers it starts afterwards, or
+// -1 where the kernel or the hypervisor does not offer the event
+static int openTlbCounter(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool runArenaBenchmark(const SimConfig *config, unsigned long long gameCount, const BatchConfig *batch)
+{
+    static const int nodeCounts[] = {1, 2, 4};
+    PageMode hugePages = batch->pages == PAGES_SMALL ? PAGES_EXPLICIT : batch->pages;
+    PageMode pageModes[] = {PAGES_SMALL, hugePages};
+
+    unsigned char *expected = NULL;
+    size_t expectedLength = 0;
+    bool ok = true;
+
+    printf("Arena benchmark: %llu games per run, %d games in flight per worker\n", gameCount, batch->gamesInFlight);
+    printf("%-5s %-7s %-6s %10s %10s %12s %8s %14s\n", "nodes", "threads", "pages", "huge MiB", "games/s", "turns/s",
+           "faults", "dTLB miss/1k");
+
+    for (int n = 0; n < 3 && ok; n++)
+    {
+        for (int p = 0; p < 2 && ok; p++)
+        {
+            BatchConfig run = *batch;
+            run.nodes = nodeCounts[n];
+            run.pages = pageModes[p];
+
+            int counter = openTlbCounter();
+            if (counter >= 0)
+            {
+                ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+                ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+            }
+
+            struct rusage before, after;
+            getrusage(RUSAGE_SELF, &before);
+
+            SimResult result;
+            BatchReport report;
+            ok = runBatch(config, 0, gameCount, &run, &result, &report);
+            getrusage(RUSAGE_SELF, &after);
+
+            unsigned long long misses = 0;
+            bool counted = false;
+            if (counter >= 0)
+            {
+                ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+                counted = read(counter, &misses, sizeof(misses)) == sizeof(misses);
+                close(counter);
+            }
+            if (!ok)
+            {
+                break;
+            }
+
+            // Every configuration has to play exactly the same games
+            unsigned char *blob;
+            size_t length = encodeSimResult(&result, &blob);
+            freeSimResult(&result);
+            if (expected == NULL)
+            {
+                expected = blob;
+                expectedLength = length;
+            }
+            else
+            {
+                ok = length == expectedLength && memcmp(blob, expected, length) == 0;
+                free(blob);
+                if (!ok)
+                {
+                    fprintf(stderr, "Results at %d nodes with %s pages differ from the first run.\n", report.nodes,
+                            getPageModeName(report.pages));
+                    break;
+                }
+            }
+
+            char tlb[32];
+            if (counted && report.turns > 0)
+            {
+                snprintf(tlb, sizeof(tlb), "%.2f", 1000.0 * misses / report.turns);
+            }
+            else
+            {
+                snprintf(tlb, sizeof(tlb), "n/a");
+            }
+            printf("%-5d %-7d %-6s %10.1f %10.1f %12.0f %8ld %14s%s\n", report.nodes, report.threads,
+                   getPageModeName(report.pages), report.hugeBytes / (1024.0 * 1024.0),
+                   report.seconds > 0 ? gameCount / report.seconds : 0.0,
+                   report.seconds > 0 ? report.turns / report.seconds : 0.0, after.ru_minflt - before.ru_minflt, tlb,
+                   report.simulatedNodes ? "  (simulated nodes)" : "");
+        }
+    }
+
+    if (ok)
+    {
+        printf("All runs produced identical results.\n");
+    }
+    free(expected);
+    return ok;
+}
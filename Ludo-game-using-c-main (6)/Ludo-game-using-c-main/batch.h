@@ -0,0 +1,45 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "arena.h"
+#include "sim.h"
+
+// Games each worker keeps in flight, stepping them a turn at a time in turn.
+// Today's engine runs fastest with one: a single game's state and detector
+// tables stay in cache, while interleaving 64 games was about 30% slower.
+#define DEFAULT_GAMES_IN_FLIGHT 1
+#define DEFAULT_BENCH_GAMES 2000
+
+typedef struct
+{
+    int threads;       // 0: one per node
+    int nodes;         // 0: the machine's own nodes
+    int gamesInFlight; // per worker
+    PageMode pages;
+} BatchConfig;
+
+typedef struct
+{
+    int threads;
+    int nodes;
+    bool simulatedNodes;
+    PageMode pages;           // weakest page size any worker ended up with
+    size_t arenaBytes;        // per worker
+    size_t hugeBytes;         // of all arenas, backed by huge pages
+    unsigned long long turns;
+    double seconds;
+} BatchReport;
+
+void initBatchConfig(BatchConfig *config);
+
+// Same result as runSimulation, played by workers pinned to nodes, each
+// holding its games in flight, detector tables and statistics in an arena
+// on its own node. Nothing is allocated per game.
+bool runBatch(const SimConfig *config, unsigned long long firstGame, unsigned long long gameCount,
+              const BatchConfig *batch, SimResult *result, BatchReport *report);
+
+// Plays the same games at 1, 2 and 4 nodes with base and huge pages and
+// reports throughput, page faults and dTLB load misses
+bool runArenaBenchmark(const SimConfig *config, unsigned long long gameCount, const BatchConfig *batch);
+
+#endif // BATCH_H
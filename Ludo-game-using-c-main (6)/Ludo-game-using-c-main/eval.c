@@ -0,0 +1,449 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "eval.h"
+#include "state.h"
+#include "strategy.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CORPUS_RECORD_SIZE (STATE_RECORD_SIZE + 1)
+
+typedef struct
+{
+    bool valid;
+    int roll;
+    int decision; // piece the strategy moves, NO_PIECE if it passes
+    double decisionWin;
+    int best;
+    double bestWin;
+    double pieceWin[PIECES_PER_PLAYER]; // negative when the piece cannot move
+} EvalResult;
+
+// Work for one mapped window of the corpus, shared by the pool
+typedef struct
+{
+    const EvalConfig *config;
+    const unsigned char *records;
+    unsigned long long windowFirst;
+    unsigned long long windowCount;
+    EvalResult *results;
+    unsigned long long next;
+    unsigned long long finished;
+    int generation;
+    bool quit;
+    pthread_mutex_t lock;
+    pthread_cond_t workReady;
+    pthread_cond_t windowDone;
+} EvalPool;
+
+void initEvalConfig(EvalConfig *config)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    config->threads = processors > 0 ? (int)processors : 1;
+    config->rollouts = DEFAULT_EVAL_ROLLOUTS;
+    config->maxTurns = DEFAULT_EVAL_MAX_TURNS;
+    config->seed = 1;
+    config->windowPositions = DEFAULT_EVAL_WINDOW;
+}
+
+static double currentTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void putCount(unsigned char *out, unsigned long long value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static unsigned long long getCount(const unsigned char *in)
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        value |= (unsigned long long)in[i] << (8 * i);
+    }
+    return value;
+}
+
+// Samples decision points (state plus the roll left after forced sixes) from
+// silently played games
+bool writeCorpus(const char *path, unsigned long long games, unsigned long long seed, int sampleEvery, int maxTurns)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    unsigned char header[CORPUS_HEADER_SIZE];
+    memcpy(header, CORPUS_MAGIC, 8);
+    putCount(header + 8, 0);
+    bool written = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    bool logWasEnabled = gameLogEnabled;
+    gameLogEnabled = false;
+    unsigned long long positions = 0;
+
+    for (unsigned long long g = 0; g < games && written; g++)
+    {
+        GameState game;
+        initializeGame(&game);
+        seedGame(&game, seed * 0xD1B54A32D192ED03ULL + g);
+        chooseFirstPlayer(&game);
+
+        for (int turn = 0; turn < maxTurns; turn++)
+        {
+            int roll = rollForTurn(&game);
+
+            if (turn % sampleEvery == 0)
+            {
+                unsigned char record[CORPUS_RECORD_SIZE];
+                serializeGameState(&game, record);
+                record[STATE_RECORD_SIZE] = (unsigned char)roll;
+                written = fwrite(record, 1, sizeof(record), file) == sizeof(record);
+                positions++;
+            }
+
+            implementPlayerBehaviors(&game, roll, game.currentPlayerIndex);
+            if (checkForWin(&game, game.currentPlayerIndex))
+            {
+                break;
+            }
+            advanceTurn(&game);
+        }
+    }
+    gameLogEnabled = logWasEnabled;
+
+    putCount(header + 8, positions);
+    written = written && fseek(file, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    if (fclose(file) != 0 || !written)
+    {
+        perror(path);
+        return false;
+    }
+
+    printf("Wrote %llu positions from %llu games to %s.\n", positions, games, path);
+    return true;
+}
+
+// Plays on from a position where the side to move has just made its move and
+// reports whether that side ends up winning
+static bool rolloutWins(GameState *game, int side, int maxTurns)
+{
+    for (int turn = 0; turn < maxTurns; turn++)
+    {
+        if (checkForWin(game, game->currentPlayerIndex))
+        {
+            return game->currentPlayerIndex == side;
+        }
+        advanceTurn(game);
+        playTurn(game);
+    }
+    return false;
+}
+
+// Every candidate replays the same rollout seeds (common random numbers), so
+// differences between moves are not drowned in dice noise
+static double rolloutWinRate(const GameState *afterMove, int side, const EvalConfig *config, unsigned long long index)
+{
+    int wins = 0;
+    for (int r = 0; r < config->rollouts; r++)
+    {
+        GameState rollout = *afterMove;
+        seedGame(&rollout, config->seed * 0xD1B54A32D192ED03ULL + index * 0x9E3779B97F4A7C15ULL + r);
+        if (rolloutWins(&rollout, side, config->maxTurns))
+        {
+            wins++;
+        }
+    }
+    return config->rollouts > 0 ? (double)wins / config->rollouts : 0.0;
+}
+
+static int movedPiece(const GameState *before, const GameState *after, int side)
+{
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        const Piece *old = &before->players[side].pieces[i];
+        const Piece *now = &after->players[side].pieces[i];
+        if (old->position != now->position || old->isBase != now->isBase || old->isHome != now->isHome)
+        {
+            return i;
+        }
+    }
+    return NO_PIECE;
+}
+
+static void evaluatePosition(const unsigned char *record, unsigned long long index, const EvalConfig *config,
+                             EvalResult *result)
+{
+    GameState position;
+    memset(result, 0, sizeof(*result));
+    result->roll = record[STATE_RECORD_SIZE];
+    result->valid = deserializeGameState(record, &position) && result->roll >= 1 && result->roll <= 6;
+    if (!result->valid)
+    {
+        return;
+    }
+
+    int side = position.currentPlayerIndex;
+    int roll = result->roll;
+
+    // The strategy's own decision
+    GameState decided = position;
+    implementPlayerBehaviors(&decided, roll, side);
+    result->decision = movedPiece(&position, &decided, side);
+    result->decisionWin = rolloutWinRate(&decided, side, config, index);
+
+    // Every legal move of a single piece
+    result->best = NO_PIECE;
+    result->bestWin = -1.0;
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        const Piece *piece = &position.players[side].pieces[i];
+        result->pieceWin[i] = -1.0;
+        if (piece->isHome || (piece->isBase && roll != 6))
+        {
+            continue;
+        }
+
+        GameState moved = position;
+        movePiece(&moved, side, i, roll);
+        result->pieceWin[i] = rolloutWinRate(&moved, side, config, index);
+        if (result->pieceWin[i] > result->bestWin)
+        {
+            result->best = i;
+            result->bestWin = result->pieceWin[i];
+        }
+    }
+    if (result->best == NO_PIECE)
+    {
+        result->bestWin = result->decisionWin;
+    }
+}
+
+static void *evalWorker(void *argument)
+{
+    EvalPool *pool = argument;
+    int seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while (!pool->quit && pool->generation == seen)
+        {
+            pthread_cond_wait(&pool->workReady, &pool->lock);
+        }
+        if (pool->quit)
+        {
+            break;
+        }
+        seen = pool->generation;
+
+        while (pool->next < pool->windowCount)
+        {
+            unsigned long long slot = pool->next++;
+            pthread_mutex_unlock(&pool->lock);
+
+            evaluatePosition(pool->records + slot * CORPUS_RECORD_SIZE, pool->windowFirst + slot, pool->config,
+                             &pool->results[slot]);
+
+            pthread_mutex_lock(&pool->lock);
+            if (++pool->finished == pool->windowCount)
+            {
+                pthread_cond_signal(&pool->windowDone);
+            }
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void writeResult(FILE *out, unsigned long long index, const EvalResult *result)
+{
+    if (!result->valid)
+    {
+        fprintf(out, "%llu invalid\n", index);
+        return;
+    }
+
+    fprintf(out, "%llu roll %d decision ", index, result->roll);
+    if (result->decision == NO_PIECE)
+    {
+        fprintf(out, "none");
+    }
+    else
+    {
+        fprintf(out, "%d", result->decision + 1);
+    }
+    fprintf(out, " %.4f best ", result->decisionWin);
+    if (result->best == NO_PIECE)
+    {
+        fprintf(out, "none");
+    }
+    else
+    {
+        fprintf(out, "%d", result->best + 1);
+    }
+    fprintf(out, " %.4f pieces", result->bestWin);
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        if (result->pieceWin[i] < 0)
+        {
+            fprintf(out, " -");
+        }
+        else
+        {
+            fprintf(out, " %.4f", result->pieceWin[i]);
+        }
+    }
+    fprintf(out, "\n");
+}
+
+// The corpus is mapped one window at a time and each window's results are
+// written in corpus order before the next one is mapped, so memory use only
+// depends on the window size, never on the corpus size
+bool evaluateCorpus(const char *corpusPath, const char *outputPath, const EvalConfig *config)
+{
+    int fd = open(corpusPath, O_RDONLY);
+    if (fd < 0)
+    {
+        perror(corpusPath);
+        return false;
+    }
+
+    struct stat info;
+    unsigned char header[CORPUS_HEADER_SIZE];
+    if (fstat(fd, &info) != 0 || read(fd, header, sizeof(header)) != (ssize_t)sizeof(header) ||
+        memcmp(header, CORPUS_MAGIC, 8) != 0)
+    {
+        fprintf(stderr, "%s is not a position corpus.\n", corpusPath);
+        close(fd);
+        return false;
+    }
+    unsigned long long positions = getCount(header + 8);
+    if ((unsigned long long)info.st_size < CORPUS_HEADER_SIZE + positions * CORPUS_RECORD_SIZE)
+    {
+        fprintf(stderr, "%s is truncated.\n", corpusPath);
+        close(fd);
+        return false;
+    }
+
+    FILE *out = outputPath != NULL ? fopen(outputPath, "w") : stdout;
+    if (out == NULL)
+    {
+        perror(outputPath);
+        close(fd);
+        return false;
+    }
+
+    unsigned long long window = config->windowPositions > 0 ? config->windowPositions : DEFAULT_EVAL_WINDOW;
+    int threads = config->threads > 0 ? config->threads : 1;
+
+    EvalPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.config = config;
+    pool.results = malloc(window * sizeof(EvalResult));
+    pthread_t *workers = malloc(threads * sizeof(pthread_t));
+    if (pool.results == NULL || workers == NULL)
+    {
+        perror("Failed to allocate evaluation buffers");
+        exit(1);
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.workReady, NULL);
+    pthread_cond_init(&pool.windowDone, NULL);
+
+    bool logWasEnabled = gameLogEnabled;
+    gameLogEnabled = false;
+
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_create(&workers[i], NULL, evalWorker, &pool);
+    }
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+    double started = currentTime();
+    bool mapped = true;
+
+    for (unsigned long long first = 0; first < positions; first += window)
+    {
+        unsigned long long count = positions - first < window ? positions - first : window;
+        off_t offset = CORPUS_HEADER_SIZE + (off_t)(first * CORPUS_RECORD_SIZE);
+        off_t mapStart = offset - offset % pageSize;
+        size_t mapLength = (size_t)(offset - mapStart) + count * CORPUS_RECORD_SIZE;
+
+        unsigned char *map = mmap(NULL, mapLength, PROT_READ, MAP_SHARED, fd, mapStart);
+        if (map == MAP_FAILED)
+        {
+            perror(corpusPath);
+            mapped = false;
+            break;
+        }
+        posix_madvise(map, mapLength, POSIX_MADV_SEQUENTIAL);
+
+        pthread_mutex_lock(&pool.lock);
+        pool.records = map + (offset - mapStart);
+        pool.windowFirst = first;
+        pool.windowCount = count;
+        pool.next = 0;
+        pool.finished = 0;
+        pool.generation++;
+        pthread_cond_broadcast(&pool.workReady);
+        while (pool.finished < count)
+        {
+            pthread_cond_wait(&pool.windowDone, &pool.lock);
+        }
+        pthread_mutex_unlock(&pool.lock);
+
+        for (unsigned long long i = 0; i < count; i++)
+        {
+            writeResult(out, first + i, &pool.results[i]);
+        }
+        fflush(out);
+        munmap(map, mapLength);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = true;
+    pthread_cond_broadcast(&pool.workReady);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    gameLogEnabled = logWasEnabled;
+
+    double elapsed = currentTime() - started;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(stderr, "Evaluated %llu positions with %d threads in %.2f s (%.1f positions/s), peak RSS %ld KiB.\n",
+            positions, threads, elapsed, elapsed > 0 ? positions / elapsed : 0.0, usage.ru_maxrss);
+
+    pthread_cond_destroy(&pool.windowDone);
+    pthread_cond_destroy(&pool.workReady);
+    pthread_mutex_destroy(&pool.lock);
+    free(workers);
+    free(pool.results);
+    if (out != stdout && fclose(out) != 0)
+    {
+        perror(outputPath);
+        mapped = false;
+    }
+    close(fd);
+    return mapped;
+}
@@ -0,0 +1,30 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "sim.h"
+
+// Corpus file: magic, position count, then fixed-size records of a state
+// record followed by the roll the player has to use
+#define CORPUS_MAGIC "LUDOPOS1"
+#define CORPUS_HEADER_SIZE 16
+
+#define DEFAULT_EVAL_ROLLOUTS 16
+#define DEFAULT_EVAL_MAX_TURNS DEFAULT_MAX_TURNS
+#define DEFAULT_EVAL_WINDOW 4096
+#define DEFAULT_CORPUS_SAMPLE 50
+#define DEFAULT_CORPUS_MAX_TURNS DEFAULT_MAX_TURNS // corpus games still going after this stop
+
+typedef struct
+{
+    int threads;
+    int rollouts;                        // rollouts per candidate move
+    int maxTurns;                        // rollouts still going after this many turns count as losses
+    unsigned long long seed;
+    unsigned long long windowPositions;  // positions mapped and buffered at a time
+} EvalConfig;
+
+void initEvalConfig(EvalConfig *config);
+bool writeCorpus(const char *path, unsigned long long games, unsigned long long seed, int sampleEvery, int maxTurns);
+bool evaluateCorpus(const char *corpusPath, const char *outputPath, const EvalConfig *config);
+
+#endif // EVAL_H
@@ -0,0 +1,134 @@
+#include "events.h"
+#include "runaway.h"
+#include <stdio.h>
+
+EventSink eventSink = NULL;
+static void *eventSinkContext = NULL;
+
+static const char *eventTypeNames[EVENT_TYPE_COUNT] = {
+    "first-roll", "first-player", "roll", "bonus-roll", "enter-board", "move", "home-path", "reached-home",
+    "overshoot", "capture", "mystery-appeared", "mystery-gone", "mystery", "energized", "sick", "briefing",
+    "direction", "sent-to-kotuwa", "block-moved", "block-refused", "blockade-broken", "game-over"};
+
+static const char *mysteryDestinations[] = {"Bhawana", "Kotuwa", "Pita-Kotuwa", "Base", "X", "Approach"};
+
+void setEventSink(EventSink sink, void *context)
+{
+    eventSink = sink;
+    eventSinkContext = context;
+}
+
+void publishGameEvent(const GameState *game, GameEvent event)
+{
+    if (eventSink == NULL)
+    {
+        return;
+    }
+    event.round = game->roundCount;
+    eventSink(eventSinkContext, &event);
+}
+
+const char *getEventTypeName(GameEventType type)
+{
+    return type < EVENT_TYPE_COUNT ? eventTypeNames[type] : "unknown";
+}
+
+static const char *seatName(int seat)
+{
+    return seat >= 0 && seat < NUM_PLAYERS ? getColorName((PlayerColor)seat) : "Nobody";
+}
+
+size_t formatGameEvent(const GameEvent *event, char *text, size_t size)
+{
+    const char *player = seatName(event->player);
+    int written;
+
+    switch (event->type)
+    {
+    case EVENT_FIRST_ROLL:
+        written = snprintf(text, size, "%s rolls %d", player, event->value);
+        break;
+    case EVENT_FIRST_PLAYER:
+        written = snprintf(text, size, "%s player has the highest roll and will begin the game.", player);
+        break;
+    case EVENT_ROLL:
+        written = snprintf(text, size, "%s player rolled %d.", player, event->value);
+        break;
+    case EVENT_BONUS_ROLL:
+        written = snprintf(text, size, "%s player rolled %d for the bonus.", player, event->value);
+        break;
+    case EVENT_ENTER_BOARD:
+        written = snprintf(text, size, "%s player moves piece %d to the starting point.", player, event->piece);
+        break;
+    case EVENT_MOVE:
+        written = snprintf(text, size, "%s moves piece %d from location %d to %d by %d units in %s direction.", player,
+                           event->piece, event->from, event->to, event->value,
+                           event->direction == CLOCKWISE ? "clockwise" : "counterclockwise");
+        break;
+    case EVENT_HOME_PATH:
+        written = snprintf(text, size, "%s moves piece %d to home path position %d.", player, event->piece,
+                           event->value);
+        break;
+    case EVENT_REACHED_HOME:
+        written = snprintf(text, size, "%s piece %d has reached home!", player, event->piece);
+        break;
+    case EVENT_OVERSHOOT:
+        written = snprintf(text, size, "%s piece %d cannot move as it would overshoot home.", player, event->piece);
+        break;
+    case EVENT_CAPTURE:
+        written = snprintf(text, size, "%s player captures %s player's piece %d!", player,
+                           seatName(event->otherPlayer), event->otherPiece);
+        break;
+    case EVENT_MYSTERY_APPEARED:
+        written = snprintf(text, size, "A mystery cell has appeared at position %d!", event->to);
+        break;
+    case EVENT_MYSTERY_GONE:
+        written = snprintf(text, size, "The mystery cell has disappeared.");
+        break;
+    case EVENT_MYSTERY_LANDED:
+        written = snprintf(text, size, "%s piece %d landed on the mystery cell and teleported to %s.", player,
+                           event->piece,
+                           event->value >= 0 && event->value < 6 ? mysteryDestinations[event->value] : "?");
+        break;
+    case EVENT_ENERGIZED:
+        written = snprintf(text, size, "%s piece %d feels energized, and movement speed doubles.", player,
+                           event->piece);
+        break;
+    case EVENT_SICK:
+        written = snprintf(text, size, "%s piece %d feels sick, and movement speed halves.", player, event->piece);
+        break;
+    case EVENT_BRIEFING:
+        written = snprintf(text, size, "%s piece %d attends briefing and cannot move for four rounds.", player,
+                           event->piece);
+        break;
+    case EVENT_DIRECTION_CHANGED:
+        written = snprintf(text, size, "%s piece %d now moves counterclockwise.", player, event->piece);
+        break;
+    case EVENT_SENT_TO_KOTUWA:
+        written = snprintf(text, size, "%s piece %d is sent on from Pita-Kotuwa to Kotuwa.", player, event->piece);
+        break;
+    case EVENT_BLOCK_MOVED:
+        written = snprintf(text, size, "%s block moved to position %d.", player, event->to);
+        break;
+    case EVENT_BLOCK_REFUSED:
+        written = snprintf(text, size, "%s cannot move its block: a block is already at the new position.", player);
+        break;
+    case EVENT_BLOCKADE_BROKEN:
+        written = snprintf(text, size, "Blockade at position %d broken by player %s.", event->to, player);
+        break;
+    case EVENT_GAME_OVER:
+        if (event->value == OUTCOME_FINISHED)
+        {
+            written = snprintf(text, size, "%s player wins!!!", player);
+        }
+        else
+        {
+            written = snprintf(text, size, "Game stopped (%s).", getOutcomeName((GameOutcome)event->value));
+        }
+        break;
+    default:
+        written = snprintf(text, size, "Unknown event %d.", event->type);
+        break;
+    }
+    return written < 0 ? 0 : (size_t)written;
+}
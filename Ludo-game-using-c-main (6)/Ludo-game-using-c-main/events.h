@@ -0,0 +1,68 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define NO_SEAT -1
+
+typedef enum
+{
+    EVENT_FIRST_ROLL,        // player, value: roll deciding who starts
+    EVENT_FIRST_PLAYER,      // player
+    EVENT_ROLL,              // player, value
+    EVENT_BONUS_ROLL,        // player, value: roll earned by a capture
+    EVENT_ENTER_BOARD,       // player, piece, to
+    EVENT_MOVE,              // player, piece, from, to, value: steps, direction
+    EVENT_HOME_PATH,         // player, piece, value: home path cell, 1-based
+    EVENT_REACHED_HOME,      // player, piece
+    EVENT_OVERSHOOT,         // player, piece
+    EVENT_CAPTURE,           // player, piece, otherPlayer, otherPiece, to
+    EVENT_MYSTERY_APPEARED,  // to, player: NO_SEAT
+    EVENT_MYSTERY_GONE,      // player: NO_SEAT
+    EVENT_MYSTERY_LANDED,    // player, piece, to, value: destination (0 Bhawana ... 5 Approach)
+    EVENT_ENERGIZED,         // player, piece
+    EVENT_SICK,              // player, piece
+    EVENT_BRIEFING,          // player, piece
+    EVENT_DIRECTION_CHANGED, // player, piece
+    EVENT_SENT_TO_KOTUWA,    // player, piece
+    EVENT_BLOCK_MOVED,       // player, piece, to
+    EVENT_BLOCK_REFUSED,     // player, piece
+    EVENT_BLOCKADE_BROKEN,   // player, to
+    EVENT_GAME_OVER,         // player: winner or NO_SEAT, value: GameOutcome
+    EVENT_TYPE_COUNT
+} GameEventType;
+
+// What the engine narrates, as data. Fields an event type does not list are
+// 0, except player, which is NO_SEAT for board events. Pieces are ids, 1-4.
+// Kept at 16 bytes, two words of a ring slot.
+typedef struct
+{
+    uint8_t type;
+    int8_t player;
+    int8_t piece;
+    int8_t otherPlayer;
+    int8_t otherPiece;
+    int8_t direction;
+    int16_t from;
+    int16_t to;
+    int16_t value;
+    int32_t round;
+} GameEvent;
+
+// Receives every event the engine publishes, on the thread playing the game.
+// There is one sink for the process and only interactive games set it;
+// without one the engine skips building events at all.
+typedef void (*EventSink)(void *context, const GameEvent *event);
+
+extern EventSink eventSink;
+
+void setEventSink(EventSink sink, void *context);
+void publishGameEvent(const GameState *game, GameEvent event); // stamps the round
+
+const char *getEventTypeName(GameEventType type);
+// Narration line of an event, without the newline
+size_t formatGameEvent(const GameEvent *event, char *text, size_t size);
+
+#endif // EVENTS_H
@@ -1,10 +1,13 @@
 #include "types.h"
+#include "events.h"
+#include "strategy.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <time.h>
 
 // Function declarations
-int rollDice();
+int rollDice(GameState *game);
 void initializeGame(GameState *game);
 void movePiece(GameState *game, int playerIndex, int pieceIndex, int steps);
 const char *getColorName(PlayerColor color);
@@ -18,9 +21,72 @@ bool isBlockCreated(GameState *game, int position);
 void breakBlockade(GameState *game, int playerIndex);
 void teleportPiece(GameState *game, int playerIndex, int pieceIndex, int destination);
 
-int rollDice()
+// Narration switch: the board renderer and batch runs turn this off
+bool gameLogEnabled = true;
+
+void gameLog(const char *format, ...)
+{
+    if (!gameLogEnabled)
+    {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+// Whether a counterclockwise piece teleported to Pita-Kotuwa goes on to Kotuwa
+bool kotuwaRecursionEnabled = true;
+
+// Structured twin of gameLog. Inlined, so that without a sink the event is
+// never even built.
+static inline void emitEvent(const GameState *game, GameEvent event)
+{
+    if (eventSink != NULL)
+    {
+        publishGameEvent(game, event);
+    }
+}
+
+static DrawHook drawHook = NULL;
+static void *drawHookContext = NULL;
+
+void setDrawHook(DrawHook hook, void *context)
 {
-    return (rand() % 6) + 1;
+    drawHook = hook;
+    drawHookContext = context;
+}
+
+// Every game carries its own generator (splitmix64) so that a seed fully
+// determines a game, whichever process or thread plays it
+void seedGame(GameState *game, unsigned long long seed)
+{
+    game->rngState = seed;
+}
+
+int randomInt(GameState *game, int bound)
+{
+    unsigned long long z = (game->rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return (int)(z % (unsigned long long)bound);
+}
+
+int rollDice(GameState *game)
+{
+    return randomInt(game, 6) + 1;
+}
+
+static int drawOutcome(GameState *game, DrawKind kind, int playerIndex, int pieceIndex, int outcomes)
+{
+    if (drawHook != NULL)
+    {
+        return drawHook(drawHookContext, game, kind, playerIndex, pieceIndex, outcomes);
+    }
+    return randomInt(game, outcomes);
 }
 int distanceBetweenPieces(int pos1, int pos2)
 {
@@ -82,12 +148,147 @@ void initializeGame(GameState *game)
             game->players[i].pieces[j].isEnergized = false;
             game->players[i].pieces[j].isSick = false;
             game->players[i].pieces[j].briefingRoundsLeft = 0;
+            game->players[i].pieces[j].canMoveAgain = false;
         }
     }
     game->mysteryCell.position = -1;
     game->mysteryCell.roundsLeft = 0;
     game->currentPlayerIndex = 0;
     game->roundCount = 1;
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        game->consecutiveSixesCount[i] = 0;
+    }
+}
+
+// Every player rolls once and the highest roll starts (first one wins ties)
+void chooseFirstPlayer(GameState *game)
+{
+    int highestRoll = 0;
+    int firstPlayer = 0;
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        int roll = rollDice(game);
+        gameLog("%s rolls %d\n", getColorName(game->players[i].color), roll);
+        emitEvent(game, (GameEvent){.type = EVENT_FIRST_ROLL, .player = i, .value = roll});
+        if (roll > highestRoll)
+        {
+            highestRoll = roll;
+            firstPlayer = i;
+        }
+    }
+
+    gameLog("%s player has the highest roll and will begin the game.\n",
+            getColorName(game->players[firstPlayer].color));
+    emitEvent(game, (GameEvent){.type = EVENT_FIRST_PLAYER, .player = firstPlayer});
+
+    game->currentPlayerIndex = firstPlayer;
+}
+
+// Rolls for the current player, including the moves forced by sixes, and
+// returns the roll left for the player's own decision
+int rollForTurn(GameState *game)
+{
+    Player *currentPlayer = &game->players[game->currentPlayerIndex];
+    int roll = drawOutcome(game, DRAW_TURN_ROLL, game->currentPlayerIndex, NO_PIECE, 6) + 1;
+
+    gameLog("\n%s player rolled %d.\n", getColorName(currentPlayer->color), roll);
+    emitEvent(game, (GameEvent){.type = EVENT_ROLL, .player = game->currentPlayerIndex, .value = roll});
+
+    while (roll == 6)
+    {
+        bool pieceMoved = false;
+
+        // Try to move a piece out of the base
+        for (int i = 0; i < PIECES_PER_PLAYER; i++)
+        {
+            if (currentPlayer->pieces[i].isBase)
+            {
+                movePiece(game, game->currentPlayerIndex, i, roll);
+                pieceMoved = true;
+                break;
+            }
+        }
+
+        // If no piece was moved out of the base, move a piece already on the board
+        if (!pieceMoved)
+        {
+            for (int i = 0; i < PIECES_PER_PLAYER; i++)
+            {
+                if (!currentPlayer->pieces[i].isBase && !currentPlayer->pieces[i].isHome)
+                {
+                    movePiece(game, game->currentPlayerIndex, i, roll);
+                    break;
+                }
+            }
+        }
+
+        roll = drawOutcome(game, DRAW_TURN_ROLL, game->currentPlayerIndex, NO_PIECE, 6) + 1; // Roll again if a 6 was rolled
+        gameLog("%s player rolled %d.\n", getColorName(currentPlayer->color), roll);
+        emitEvent(game, (GameEvent){.type = EVENT_ROLL, .player = game->currentPlayerIndex, .value = roll});
+    }
+
+    if (roll == 6)
+    {
+        game->consecutiveSixesCount[game->currentPlayerIndex]++;
+
+        if (game->consecutiveSixesCount[game->currentPlayerIndex] == 3)
+        {
+            // Player has rolled three sixes in a row
+            breakBlockade(game, game->currentPlayerIndex);
+            game->consecutiveSixesCount[game->currentPlayerIndex] = 0; // Reset the counter
+        }
+    }
+    else
+    {
+        game->consecutiveSixesCount[game->currentPlayerIndex] = 0; // Reset if not a six
+    }
+
+    return roll;
+}
+
+// Plays the current player's turn and returns the last roll. The caller checks
+// for a win before calling advanceTurn.
+int playTurn(GameState *game)
+{
+    int roll = rollForTurn(game);
+    implementPlayerBehaviors(game, roll, game->currentPlayerIndex);
+    return roll;
+}
+
+// Hands the turn to the next player and runs the end-of-round bookkeeping
+void advanceTurn(GameState *game)
+{
+    game->currentPlayerIndex = (game->currentPlayerIndex + 1) % NUM_PLAYERS;
+
+    // Check if the round is complete (i.e., all players have taken their turns)
+    if (game->currentPlayerIndex == 0)
+    {
+        game->roundCount++;
+        // Update mystery cell if needed
+        if (game->roundCount % 4 == 0)
+        {
+            // Implement mystery cell logic here
+            if (game->roundCount % 4 == 0)
+            {
+                game->mysteryCell.position = randomInt(game, BOARD_SIZE); // Randomly place the mystery cell
+                game->mysteryCell.roundsLeft = 3;                         // It will stay for 3 rounds
+                gameLog("A mystery cell has appeared at position %d!\n", game->mysteryCell.position);
+                emitEvent(game, (GameEvent){.type = EVENT_MYSTERY_APPEARED, .player = NO_SEAT,
+                                            .to = game->mysteryCell.position});
+            }
+            else if (game->mysteryCell.roundsLeft > 0)
+            {
+                game->mysteryCell.roundsLeft--;
+                if (game->mysteryCell.roundsLeft == 0)
+                {
+                    game->mysteryCell.position = -1; // Remove mystery cell
+                    gameLog("The mystery cell has disappeared.\n");
+                    emitEvent(game, (GameEvent){.type = EVENT_MYSTERY_GONE, .player = NO_SEAT});
+                }
+            }
+        }
+    }
 }
 
 void movePiece(GameState *game, int playerIndex, int pieceIndex, int steps)
@@ -100,8 +301,10 @@ void movePiece(GameState *game, int playerIndex, int pieceIndex, int steps)
         piece->isBase = false;
         piece->position = startingPosition;
         game->players[playerIndex].piecesInBase--;
-        printf("%s player moves piece %d to the starting point.\n",
+        gameLog("%s player moves piece %d to the starting point.\n",
                getColorName(piece->color), piece->id);
+        emitEvent(game, (GameEvent){.type = EVENT_ENTER_BOARD, .player = playerIndex, .piece = piece->id,
+                                    .to = startingPosition});
     }
     else if (!piece->isBase && !piece->isHome)
     {
@@ -125,28 +328,35 @@ void movePiece(GameState *game, int playerIndex, int pieceIndex, int steps)
             if (homePathPosition <= HOME_PATH_SIZE)
             {
                 piece->position = playerIndex * HOME_PATH_SIZE + homePathPosition; // Calculate absolute home position
-                printf("%s moves piece %d to home path position %d.\n",
+                gameLog("%s moves piece %d to home path position %d.\n",
                        getColorName(piece->color), piece->id, homePathPosition + 1); // Display 1-based position
+                emitEvent(game, (GameEvent){.type = EVENT_HOME_PATH, .player = playerIndex, .piece = piece->id,
+                                            .value = homePathPosition + 1});
 
                 if (homePathPosition == HOME_PATH_SIZE) 
                 {
                     piece->isHome = true;
                     game->players[playerIndex].piecesInHome++;
-                    printf("%s piece %d has reached home!\n", getColorName(piece->color), piece->id);
+                    gameLog("%s piece %d has reached home!\n", getColorName(piece->color), piece->id);
+                    emitEvent(game, (GameEvent){.type = EVENT_REACHED_HOME, .player = playerIndex, .piece = piece->id});
                 }
             }
             else
             {
-                printf("%s piece %d cannot move as it would overshoot home.\n", getColorName(piece->color), piece->id);
+                gameLog("%s piece %d cannot move as it would overshoot home.\n", getColorName(piece->color), piece->id);
+                emitEvent(game, (GameEvent){.type = EVENT_OVERSHOOT, .player = playerIndex, .piece = piece->id});
                 return; // Don't move the piece
             }
         }
         else
         {
             // Normal movement
-            printf("%s moves piece %d from location %d to %d by %d units in %s direction.\n",
+            gameLog("%s moves piece %d from location %d to %d by %d units in %s direction.\n",
                    getColorName(piece->color), piece->id, piece->position, newPosition,
                    steps, (piece->direction == CLOCKWISE) ? "clockwise" : "counterclockwise");
+            emitEvent(game, (GameEvent){.type = EVENT_MOVE, .player = playerIndex, .piece = piece->id,
+                                        .from = piece->position, .to = newPosition, .value = steps,
+                                        .direction = piece->direction});
             piece->position = newPosition;
         }
 
@@ -176,14 +386,18 @@ void checkForCaptures(GameState *game, int playerIndex, int pieceIndex)
                     game->players[i].piecesInBase++;
                     movingPiece->captures++;
 
-                    printf("%s player captures %s player's piece %d!\n",
+                    gameLog("%s player captures %s player's piece %d!\n",
                            getColorName(movingPiece->color),
                            getColorName(otherPiece->color), otherPiece->id);
+                    emitEvent(game, (GameEvent){.type = EVENT_CAPTURE, .player = playerIndex, .piece = movingPiece->id,
+                                                .otherPlayer = i, .otherPiece = otherPiece->id,
+                                                .to = movingPiece->position});
 
                     // Rule CS-2: Bonus roll for capture
-                    printf("%s player gets a bonus roll for capturing.\n", getColorName(movingPiece->color));
-                    int bonusRoll = rollDice();
-                    printf("%s player rolled %d for the bonus.\n", getColorName(movingPiece->color), bonusRoll);
+                    gameLog("%s player gets a bonus roll for capturing.\n", getColorName(movingPiece->color));
+                    int bonusRoll = drawOutcome(game, DRAW_BONUS_ROLL, playerIndex, pieceIndex, 6) + 1;
+                    gameLog("%s player rolled %d for the bonus.\n", getColorName(movingPiece->color), bonusRoll);
+                    emitEvent(game, (GameEvent){.type = EVENT_BONUS_ROLL, .player = playerIndex, .value = bonusRoll});
                     movePiece(game, playerIndex, pieceIndex, bonusRoll);
                 }
             }
@@ -197,13 +411,15 @@ void handleMysteryCell(GameState *game, int playerIndex, int pieceIndex)
 
     if (game->mysteryCell.position != -1 && piece->position == game->mysteryCell.position)
     {
-        printf("%s player's piece %d landed on the mystery cell!\n",
+        gameLog("%s player's piece %d landed on the mystery cell!\n",
                getColorName(piece->color), piece->id);
 
         // Randomly select teleport destination
-        int destination = rand() % 6;
+        int destination = drawOutcome(game, DRAW_MYSTERY_DESTINATION, playerIndex, pieceIndex, 6);
         const char *destinations[] = {"Bhawana", "Kotuwa", "Pita-Kotuwa", "Base", "X", "Approach"};
-        printf("%s piece %d teleported to %s.\n", getColorName(piece->color), piece->id, destinations[destination]);
+        gameLog("%s piece %d teleported to %s.\n", getColorName(piece->color), piece->id, destinations[destination]);
+        emitEvent(game, (GameEvent){.type = EVENT_MYSTERY_LANDED, .player = playerIndex, .piece = piece->id,
+                                    .to = piece->position, .value = destination});
 
         teleportPiece(game, playerIndex, pieceIndex, destination);
 
@@ -219,32 +435,37 @@ void teleportPiece(GameState *game, int playerIndex, int pieceIndex, int destina
     {
     case 0: // Bhawana
         piece->position = 9;
-        if (rand() % 2 == 0)
+        if (randomInt(game, 2) == 0)
         {
             piece->isEnergized = true;
-            printf("%s piece %d feels energized, and movement speed doubles.\n", getColorName(piece->color), piece->id);
+            gameLog("%s piece %d feels energized, and movement speed doubles.\n", getColorName(piece->color), piece->id);
+            emitEvent(game, (GameEvent){.type = EVENT_ENERGIZED, .player = playerIndex, .piece = piece->id});
         }
         else
         {
             piece->isSick = true;
-            printf("%s piece %d feels sick, and movement speed halves.\n", getColorName(piece->color), piece->id);
+            gameLog("%s piece %d feels sick, and movement speed halves.\n", getColorName(piece->color), piece->id);
+            emitEvent(game, (GameEvent){.type = EVENT_SICK, .player = playerIndex, .piece = piece->id});
         }
         break;
     case 1: // Kotuwa
         piece->position = 2;
         piece->briefingRoundsLeft = 4;
-        printf("%s piece %d attends briefing and cannot move for four rounds.\n", getColorName(piece->color), piece->id);
+        gameLog("%s piece %d attends briefing and cannot move for four rounds.\n", getColorName(piece->color), piece->id);
+        emitEvent(game, (GameEvent){.type = EVENT_BRIEFING, .player = playerIndex, .piece = piece->id});
         break;
     case 2: // Pita-Kotuwa
         piece->position = 46;
         if (piece->direction == CLOCKWISE)
         {
             piece->direction = COUNTERCLOCKWISE;
-            printf("The %s piece %d, which was moving clockwise, has changed to moving counterclockwise.\n", getColorName(piece->color), piece->id);
+            gameLog("The %s piece %d, which was moving clockwise, has changed to moving counterclockwise.\n", getColorName(piece->color), piece->id);
+            emitEvent(game, (GameEvent){.type = EVENT_DIRECTION_CHANGED, .player = playerIndex, .piece = piece->id});
         }
-        else
+        else if (kotuwaRecursionEnabled)
         {
-            printf("The %s piece %d is moving in a counterclockwise direction. Teleporting to Kotuwa from Pita-Kotuwa.\n", getColorName(piece->color), piece->id);
+            gameLog("The %s piece %d is moving in a counterclockwise direction. Teleporting to Kotuwa from Pita-Kotuwa.\n", getColorName(piece->color), piece->id);
+            emitEvent(game, (GameEvent){.type = EVENT_SENT_TO_KOTUWA, .player = playerIndex, .piece = piece->id});
             teleportPiece(game, playerIndex, pieceIndex, 1); // Teleport to Kotuwa
         }
         break;
@@ -267,252 +488,34 @@ bool checkForWin(GameState *game, int playerIndex)
     return game->players[playerIndex].piecesInHome == PIECES_PER_PLAYER;
 }
 
-// Function to find a random movable piece for a given player
-int findRandomMovablePiece(Player* player) {
-    int movablePieces[PIECES_PER_PLAYER];
-    int numMovablePieces = 0;
-    for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-        if (!player->pieces[i].isBase && !player->pieces[i].isHome) {
-            movablePieces[numMovablePieces++] = i;
-        }
-    }
-    if (numMovablePieces > 0) {
-        return movablePieces[rand() % numMovablePieces];
-    }
-    return -1; // No movable pieces found
-}
-
-void implementPlayerBehaviors(GameState *game, int diceRoll, int playerIndex) {
-    Player *currentPlayer = &game->players[playerIndex];
-    int startingPosition = (playerIndex * 13 + 2) % BOARD_SIZE;
-    PlayerColor color = currentPlayer->color;
-
-    // Helper function to find a random movable piece
-    // (You might want to move this outside implementPlayerBehaviors 
-    // to avoid code repetition)
-    
-
-    switch (color) {
-        case RED: {
-            // 1. Prioritize Capturing:
-            int nearestOpponentDistance = BOARD_SIZE + 1;
-            int pieceToMove = -1;
-
-            for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-                Piece *piece = &currentPlayer->pieces[i]; 
-                if (!piece->isBase && !piece->isHome) {
-                    for (int j = 0; j < NUM_PLAYERS; j++) {
-                        if (j != game->currentPlayerIndex) {
-                            for (int k = 0; k < PIECES_PER_PLAYER; k++) {
-                                Piece *opponentPiece = &game->players[j].pieces[k];
-                                if (!opponentPiece->isBase && !opponentPiece->isHome) {
-                                    int distanceToOpponent = distanceBetweenPieces(piece->position, opponentPiece->position);
-                                    if (distanceToOpponent == diceRoll && distanceToOpponent < nearestOpponentDistance) {
-                                        nearestOpponentDistance = distanceToOpponent;
-                                        pieceToMove = i; 
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            if (pieceToMove != -1) {
-                movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-                printf("RED player is moving to capture!\n");
-                return; 
-            }
-
-            // 2. Move Piece from Base:
-            if (diceRoll == 6 && currentPlayer->piecesInBase > 0) {
-                pieceToMove = -1;
-                for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-                    if (currentPlayer->pieces[i].isBase) {
-                        pieceToMove = i;
-                        break;
-                    }
-                }
-
-                if (pieceToMove != -1) { 
-                    movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-                    printf("RED player moves a piece from base to X.\n");
-                    return;
-                } 
-            }
-
-            // 3. Move other movable pieces:
-            pieceToMove = findRandomMovablePiece(currentPlayer);
-            if (pieceToMove != -1) {
-                movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-                printf("RED player moves a piece already on the board.\n");
-                return;
-            }
-            break;
-        }
-
-        case GREEN: {
-    // 1. Move from Base to X if possible (considering blocks):
-    if (diceRoll == 6 && currentPlayer->piecesInBase > 0) {
-        int pieceToMove = -1;
-        for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-            if (currentPlayer->pieces[i].isBase) {
-                // Check if moving to X would create a block, but allow if less than 2 pieces in base
-                if (!(isBlockCreated(game, startingPosition) && currentPlayer->piecesInBase <= 2)) { 
-                    pieceToMove = i;
-                    break;
-                } else {
-                    printf("GREEN player chooses to keep a piece in the base to avoid a potential block.\n");
-                }
-            }
-        }
-
-        if (pieceToMove != -1) {
-            movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-            printf("GREEN player moves a piece from the base to X.\n");
-            return;  
-        }
-    }
-
-    // 2. Attempt to create or maintain a block:
-    int pieceToMove = -1;
-    for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-        if (canMoveBlock(game, game->currentPlayerIndex, i, diceRoll)) { // Check if a block can be made
-            pieceToMove = i;
-            break;
-        }
-    }
-    if (pieceToMove != -1) {
-        moveBlock(game, game->currentPlayerIndex, pieceToMove, diceRoll); // Move only if a block can be made
-        return; // Only move one piece per roll
-    }
-
-    // 3. Move other pieces towards home (randomly):
-    pieceToMove = findRandomMovablePiece(currentPlayer);
-    if (pieceToMove != -1) {
-        movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-        printf("GREEN player moves a piece already on the board.\n");
-        return; 
-    }
-    break; 
-}
-
-        case YELLOW: { 
-            // 1. Move from base to X if possible
-            if (diceRoll == 6 && currentPlayer->piecesInBase > 0) {
-                int pieceToMove = -1;
-                for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-                    if (currentPlayer->pieces[i].isBase) {
-                        pieceToMove = i;
-                        break;
-                    }
-                }
-                if (pieceToMove != -1) {
-                    movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-                    printf("YELLOW player moves a piece from the base to X.\n");
-                    return; 
-                }
-            }
-
-            // 2. Capture if possible 
-            int pieceToMove = -1;
-            for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-                Piece *piece = &currentPlayer->pieces[i];
-                if (!piece->isBase && !piece->isHome && piece->captures < 1) { 
-                    for (int j = 0; j < NUM_PLAYERS; j++) {
-                        if (j != game->currentPlayerIndex) {
-                            for (int k = 0; k < PIECES_PER_PLAYER; k++) {
-                                Piece *opponentPiece = &game->players[j].pieces[k];
-                                if (!opponentPiece->isBase && !opponentPiece->isHome) {
-                                    int distanceToOpponent = distanceBetweenPieces(piece->position, opponentPiece->position);
-                                    if (distanceToOpponent == diceRoll) {
-                                        pieceToMove = i;
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            if (pieceToMove != -1) {
-                movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-                printf("YELLOW player is moving to capture to enter the home path!\n");
-                return; 
-            }
-
-            // 3. Prioritize moving the piece closest to home
-            int closestToHomeDistance = BOARD_SIZE + 1;
-            pieceToMove = -1;
-
-            for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-                Piece *piece = &currentPlayer->pieces[i];
-                if (!piece->isHome && !piece->isBase) {
-                    int distanceFromHome = distanceBetweenPieces(piece->position, startingPosition);
-                    if (distanceFromHome < closestToHomeDistance) {
-                        closestToHomeDistance = distanceFromHome;
-                        pieceToMove = i;
-                    }
-                }
-            }
-
-            if (pieceToMove != -1) {
-                movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-                // ... (rest of your YELLOW player logic) ...
-                return; 
-            }
-            break; 
-        }
+// Asks the seat's strategy for a move, giving it the board scans it needs
+// precomputed, and carries the move out
+void implementPlayerBehaviors(GameState *game, int diceRoll, int playerIndex)
+{
+    TurnFeatures features;
+    buildTurnFeatures(game, playerIndex, diceRoll, &features);
 
-        case BLUE: {
-    // 1. Move the piece that has been on the board the longest 
-    int pieceToMove = -1;
-    int oldestRound = game->roundCount; // Initialize with a high round number
-
-    for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-        Piece *piece = &currentPlayer->pieces[i];
-        if (!piece->isBase && !piece->isHome) {
-            // Track when each piece left the base 
-            if (piece->position >= 0 && piece->position < BOARD_SIZE) { // Check if piece is on main track
-                int roundsOnBoard = game->roundCount - (piece->briefingRoundsLeft + 1); // Approximation
-                if (roundsOnBoard < oldestRound) {
-                    oldestRound = roundsOnBoard;
-                    pieceToMove = i;
-                }
-            }
-        }
+    StrategyMove move = getSeatStrategy(playerIndex)->decide(game, &features);
+    if (move.aside != NULL)
+    {
+        gameLog("%s", move.aside);
     }
-
-    if (pieceToMove != -1) {
-        movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-        printf("BLUE player moves the oldest piece on the board.\n");
-        return; 
+    if (move.action == ACTION_PASS || move.piece < 0 || move.piece >= PIECES_PER_PLAYER)
+    {
+        return;
     }
 
-    // 2. If no pieces are on the board, try to move a piece from the base
-    if (diceRoll == 6 && currentPlayer->piecesInBase > 0) { 
-        for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-            if (currentPlayer->pieces[i].isBase) {
-                pieceToMove = i;
-                break;
-            }
-        }
-        if (pieceToMove != -1) {
-            movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-            printf("BLUE player moves a piece from the base to X.\n");
-            return; 
-        }
+    if (move.action == ACTION_MOVE_BLOCK)
+    {
+        moveBlock(game, playerIndex, move.piece, diceRoll);
     }
-
-    // 3. Move other movable pieces (randomly) if no older piece can move
-    pieceToMove = findRandomMovablePiece(currentPlayer);
-    if (pieceToMove != -1) {
-        movePiece(game, game->currentPlayerIndex, pieceToMove, diceRoll);
-        printf("BLUE player moves a piece randomly.\n");
-        return; 
+    else
+    {
+        movePiece(game, playerIndex, move.piece, diceRoll);
     }
-    break; 
-}
+    if (move.note != NULL)
+    {
+        gameLog("%s", move.note);
     }
 }
 
@@ -531,12 +534,14 @@ void moveBlock(GameState *game, int playerIndex, int pieceIndex, int steps)
     // Check if a block is created at the new position
     if (isBlockCreated(game, newPosition))
     {
-        printf("A block is already created at the new position.\n");
+        gameLog("A block is already created at the new position.\n");
+        emitEvent(game, (GameEvent){.type = EVENT_BLOCK_REFUSED, .player = playerIndex, .piece = piece->id});
         return;
     }
 
     piece->position = newPosition;
-    printf("Block moved to position %d.\n", newPosition);
+    gameLog("Block moved to position %d.\n", newPosition);
+    emitEvent(game, (GameEvent){.type = EVENT_BLOCK_MOVED, .player = playerIndex, .piece = piece->id, .to = newPosition});
 }
 
 // Check if a block is created at a given position (CS-5)
@@ -574,7 +579,8 @@ void breakBlockade(GameState *game, int playerIndex)
             {
                 // Logic to break the blockade
                 // Placeholder for breaking the block
-                printf("Blockade at position %d broken by player %s.\n", blockPosition, getColorName(player->color));
+                gameLog("Blockade at position %d broken by player %s.\n", blockPosition, getColorName(player->color));
+                emitEvent(game, (GameEvent){.type = EVENT_BLOCKADE_BROKEN, .player = playerIndex, .to = blockPosition});
                 break;
             }
         }
@@ -601,41 +607,41 @@ const char *getColorName(PlayerColor color)
 void printGameStatus(GameState *game)
 {
 
-    printf("Round: %d\n", game->roundCount);
+    gameLog("Round: %d\n", game->roundCount);
 
     for (int i = 0; i < NUM_PLAYERS; i++)
     {
-        printf("%s player now has %d/4 pieces on the board and %d/4 pieces on the base.\n",
+        gameLog("%s player now has %d/4 pieces on the board and %d/4 pieces on the base.\n",
                getColorName(game->players[i].color),
                PIECES_PER_PLAYER - game->players[i].piecesInBase - game->players[i].piecesInHome,
                game->players[i].piecesInBase);
 
-        printf("============================\n");
-        printf("Location of pieces %s\n", getColorName(game->players[i].color));
-        printf("============================\n");
+        gameLog("============================\n");
+        gameLog("Location of pieces %s\n", getColorName(game->players[i].color));
+        gameLog("============================\n");
 
         for (int j = 0; j < PIECES_PER_PLAYER; j++)
         {
             Piece *piece = &game->players[i].pieces[j];
             if (piece->isBase)
             {
-                printf("Piece %d -> Base\n", piece->id);
+                gameLog("Piece %d -> Base\n", piece->id);
             }
             else if (piece->isHome)
             {
-                printf("Piece %d -> Home\n", piece->id);
+                gameLog("Piece %d -> Home\n", piece->id);
             }
             else
             {
-                printf("Piece %d -> %d\n", piece->id, piece->position);
+                gameLog("Piece %d -> %d\n", piece->id, piece->position);
             }
         }
-        printf("\n");
+        gameLog("\n");
     }
 
     if (game->mysteryCell.position != -1)
     {
-        printf("The mystery cell is at %d and will be at that location for the next %d rounds.\n",
+        gameLog("The mystery cell is at %d and will be at that location for the next %d rounds.\n",
                game->mysteryCell.position, game->mysteryCell.roundsLeft);
     }
 }
\ No newline at end of file
@@ -0,0 +1,448 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "lockstep.h"
+#include "state.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REPRODUCER_MAGIC "LUDOREP1"
+
+typedef enum
+{
+    STEP_PLAY_TURN,
+    STEP_ADVANCE_TURN
+} StepPhase;
+
+static const char *phaseNames[] = {"playTurn", "advanceTurn"};
+
+// ---------------------------------------------------------------------------
+// Reference engine: game_logic.c itself
+
+static void *createReference(void)
+{
+    GameState *game = malloc(sizeof(GameState));
+    if (game == NULL)
+    {
+        perror("Failed to allocate engine");
+        exit(1);
+    }
+    return game;
+}
+
+static void destroyReference(void *engine)
+{
+    free(engine);
+}
+
+static void loadReference(void *engine, const GameState *state)
+{
+    *(GameState *)engine = *state;
+}
+
+static void storeReference(void *engine, GameState *state)
+{
+    *state = *(GameState *)engine;
+}
+
+static int playReferenceTurn(void *engine)
+{
+    return playTurn(engine);
+}
+
+static void advanceReferenceTurn(void *engine)
+{
+    advanceTurn(engine);
+}
+
+// ---------------------------------------------------------------------------
+// Deliberately broken engine used to check that the harness catches a quirk
+// that only shows up in rare positions: teleportPiece leaves a piece that
+// already moves counterclockwise on Pita-Kotuwa instead of sending it on to
+// Kotuwa.
+
+static int playMutantTurn(void *engine)
+{
+    kotuwaRecursionEnabled = false;
+    int roll = playTurn(engine);
+    kotuwaRecursionEnabled = true;
+    return roll;
+}
+
+// Alternative engines are added to this table
+static const EngineOps engines[] = {
+    {"reference", "game_logic.c as is", createReference, destroyReference, loadReference, storeReference,
+     playReferenceTurn, advanceReferenceTurn},
+    {"mutant-kotuwa", "reference without the Pita-Kotuwa -> Kotuwa recursion (harness self-test)", createReference,
+     destroyReference, loadReference, storeReference, playMutantTurn, advanceReferenceTurn},
+};
+
+#define ENGINE_COUNT (int)(sizeof(engines) / sizeof(engines[0]))
+
+const EngineOps *findEngine(const char *name)
+{
+    for (int i = 0; i < ENGINE_COUNT; i++)
+    {
+        if (strcmp(engines[i].name, name) == 0)
+        {
+            return &engines[i];
+        }
+    }
+    return NULL;
+}
+
+void listEngines(FILE *out)
+{
+    for (int i = 0; i < ENGINE_COUNT; i++)
+    {
+        fprintf(out, "  %-15s %s\n", engines[i].name, engines[i].description);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+void initLockstepConfig(LockstepConfig *config)
+{
+    config->reference = &engines[0];
+    config->candidate = &engines[0];
+    config->seed = 1;
+    config->games = 1000;
+    config->maxTurns = LOCKSTEP_DEFAULT_MAX_TURNS;
+    config->scramble = false;
+    config->reproducerPath = LOCKSTEP_DEFAULT_REPRODUCER;
+}
+
+static double currentTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Random but consistent position: pieces spread over base, track and home,
+// with the rarer piece states (counterclockwise, briefing, energized, sick,
+// captures that open the home path) far more common than in real games
+static void scrambleGame(GameState *game, GameState *generator)
+{
+    initializeGame(game);
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        Player *player = &game->players[i];
+        for (int j = 0; j < PIECES_PER_PLAYER; j++)
+        {
+            Piece *piece = &player->pieces[j];
+            int kind = randomInt(generator, 10);
+
+            if (kind < 3)
+            {
+                continue; // stays in the base
+            }
+
+            piece->isBase = false;
+            player->piecesInBase--;
+
+            if (kind == 3 && player->piecesInHome < PIECES_PER_PLAYER - 1)
+            {
+                piece->isHome = true;
+                piece->position = i * HOME_PATH_SIZE + HOME_PATH_SIZE;
+                player->piecesInHome++;
+                continue;
+            }
+
+            piece->position = randomInt(generator, BOARD_SIZE);
+            piece->direction = randomInt(generator, 4) == 0 ? COUNTERCLOCKWISE : CLOCKWISE;
+            piece->captures = randomInt(generator, 3);
+            piece->isEnergized = randomInt(generator, 8) == 0;
+            piece->isSick = randomInt(generator, 8) == 0;
+            piece->briefingRoundsLeft = randomInt(generator, 6) == 0 ? randomInt(generator, 5) : 0;
+        }
+        game->consecutiveSixesCount[i] = randomInt(generator, 3);
+    }
+
+    if (randomInt(generator, 2) == 0)
+    {
+        game->mysteryCell.position = randomInt(generator, BOARD_SIZE);
+        game->mysteryCell.roundsLeft = randomInt(generator, 4);
+    }
+    game->roundCount = 1 + randomInt(generator, 40);
+    game->currentPlayerIndex = randomInt(generator, NUM_PLAYERS);
+}
+
+static void makeStartingState(const LockstepConfig *config, unsigned long long gameIndex, GameState *game)
+{
+    unsigned long long seed = config->seed * 0xD1B54A32D192ED03ULL + gameIndex;
+
+    if (config->scramble)
+    {
+        GameState generator;
+        seedGame(&generator, ~seed);
+        scrambleGame(game, &generator);
+    }
+    else
+    {
+        initializeGame(game);
+    }
+    seedGame(game, seed);
+
+    if (!config->scramble)
+    {
+        chooseFirstPlayer(game);
+    }
+}
+
+static int runStep(const EngineOps *ops, void *engine, StepPhase phase)
+{
+    if (phase == STEP_PLAY_TURN)
+    {
+        return ops->playTurn(engine);
+    }
+    ops->advanceTurn(engine);
+    return 0;
+}
+
+// Runs one step from the same state on fresh engines. Returns true when the
+// engines disagree on the returned roll or on the resulting state.
+static bool stepDiverges(const EngineOps *reference, const EngineOps *candidate, const GameState *state,
+                         StepPhase phase, GameState *referenceAfter, GameState *candidateAfter,
+                         int *referenceRoll, int *candidateRoll)
+{
+    void *left = reference->create();
+    void *right = candidate->create();
+    reference->load(left, state);
+    candidate->load(right, state);
+
+    *referenceRoll = runStep(reference, left, phase);
+    *candidateRoll = runStep(candidate, right, phase);
+    reference->store(left, referenceAfter);
+    candidate->store(right, candidateAfter);
+
+    reference->destroy(left);
+    candidate->destroy(right);
+
+    return *referenceRoll != *candidateRoll || diffGameStates(referenceAfter, candidateAfter, NULL) > 0;
+}
+
+static bool stillDiverges(const LockstepConfig *config, const GameState *state, StepPhase phase)
+{
+    GameState left, right;
+    int leftRoll, rightRoll;
+    return stepDiverges(config->reference, config->candidate, state, phase, &left, &right, &leftRoll, &rightRoll);
+}
+
+static void sendPieceToBase(GameState *game, int playerIndex, int pieceIndex)
+{
+    Player *player = &game->players[playerIndex];
+    Piece *piece = &player->pieces[pieceIndex];
+
+    if (piece->isHome)
+    {
+        player->piecesInHome--;
+    }
+    if (!piece->isBase)
+    {
+        player->piecesInBase++;
+    }
+    piece->isBase = true;
+    piece->isHome = false;
+    piece->position = -1;
+    piece->direction = CLOCKWISE;
+    piece->captures = 0;
+    piece->isEnergized = false;
+    piece->isSick = false;
+    piece->briefingRoundsLeft = 0;
+}
+
+// Greedy shrinking: every simplification that keeps the step divergent is
+// kept, until a full pass changes nothing. The random stream is left alone
+// since it decides the rolls that expose the problem.
+static void minimizeState(const LockstepConfig *config, GameState *state, StepPhase phase)
+{
+    bool shrunk = true;
+
+    while (shrunk)
+    {
+        shrunk = false;
+        GameState trial;
+
+#define TRY_SIMPLIFICATION(condition, change)                \
+    if (condition)                                           \
+    {                                                        \
+        trial = *state;                                      \
+        change;                                              \
+        if (stillDiverges(config, &trial, phase))            \
+        {                                                    \
+            *state = trial;                                  \
+            shrunk = true;                                   \
+        }                                                    \
+    }
+
+        for (int i = 0; i < NUM_PLAYERS; i++)
+        {
+            for (int j = 0; j < PIECES_PER_PLAYER; j++)
+            {
+                Piece *piece = &state->players[i].pieces[j];
+                Piece *trialPiece = &trial.players[i].pieces[j];
+
+                TRY_SIMPLIFICATION(!piece->isBase, sendPieceToBase(&trial, i, j));
+                TRY_SIMPLIFICATION(piece->captures > 0, trialPiece->captures = 0);
+                TRY_SIMPLIFICATION(piece->direction != CLOCKWISE, trialPiece->direction = CLOCKWISE);
+                TRY_SIMPLIFICATION(piece->isEnergized, trialPiece->isEnergized = false);
+                TRY_SIMPLIFICATION(piece->isSick, trialPiece->isSick = false);
+                TRY_SIMPLIFICATION(piece->briefingRoundsLeft > 0, trialPiece->briefingRoundsLeft = 0);
+            }
+            TRY_SIMPLIFICATION(state->consecutiveSixesCount[i] > 0, trial.consecutiveSixesCount[i] = 0);
+        }
+        TRY_SIMPLIFICATION(state->mysteryCell.position != -1,
+                           (trial.mysteryCell.position = -1, trial.mysteryCell.roundsLeft = 0));
+        TRY_SIMPLIFICATION(state->roundCount != 1, trial.roundCount = 1);
+
+#undef TRY_SIMPLIFICATION
+    }
+}
+
+static bool writeReproducer(const char *path, const GameState *state, StepPhase phase)
+{
+    unsigned char record[STATE_RECORD_SIZE];
+    serializeGameState(state, record);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    unsigned char phaseByte = (unsigned char)phase;
+    bool written = fwrite(REPRODUCER_MAGIC, 1, 8, file) == 8 && fwrite(&phaseByte, 1, 1, file) == 1 &&
+                   fwrite(record, 1, sizeof(record), file) == sizeof(record);
+    if (fclose(file) != 0 || !written)
+    {
+        perror(path);
+        return false;
+    }
+    return true;
+}
+
+static void reportDivergence(const LockstepConfig *config, const GameState *state, StepPhase phase)
+{
+    GameState left, right;
+    int leftRoll, rightRoll;
+    stepDiverges(config->reference, config->candidate, state, phase, &left, &right, &leftRoll, &rightRoll);
+
+    printf("State before the step:\n");
+    dumpGameState(state, stdout);
+    if (leftRoll != rightRoll)
+    {
+        printf("roll: %d != %d\n", leftRoll, rightRoll);
+    }
+    printf("Differences (%s | %s):\n", config->reference->name, config->candidate->name);
+    diffGameStates(&left, &right, stdout);
+}
+
+bool runLockstep(const LockstepConfig *config)
+{
+    bool logWasEnabled = gameLogEnabled;
+    gameLogEnabled = false;
+
+    void *left = config->reference->create();
+    void *right = config->candidate->create();
+    unsigned long long turnsPlayed = 0;
+    bool diverged = false;
+    double started = currentTime();
+
+    for (unsigned long long gameIndex = 0; gameIndex < config->games && !diverged; gameIndex++)
+    {
+        GameState before, leftState, rightState;
+        makeStartingState(config, gameIndex, &before);
+        config->reference->load(left, &before);
+        config->candidate->load(right, &before);
+
+        for (int turn = 0; turn < config->maxTurns && !diverged; turn++)
+        {
+            for (int phase = STEP_PLAY_TURN; phase <= STEP_ADVANCE_TURN; phase++)
+            {
+                int leftRoll = runStep(config->reference, left, phase);
+                int rightRoll = runStep(config->candidate, right, phase);
+                config->reference->store(left, &leftState);
+                config->candidate->store(right, &rightState);
+
+                if (leftRoll != rightRoll || diffGameStates(&leftState, &rightState, NULL) > 0)
+                {
+                    printf("Engines diverged in game %llu, turn %d, %s.\n", gameIndex, turn, phaseNames[phase]);
+                    minimizeState(config, &before, phase);
+                    reportDivergence(config, &before, phase);
+                    if (writeReproducer(config->reproducerPath, &before, phase))
+                    {
+                        printf("Reproducer written to %s (replay with --replay %s --engine %s).\n",
+                               config->reproducerPath, config->reproducerPath, config->candidate->name);
+                    }
+                    diverged = true;
+                    break;
+                }
+
+                before = leftState;
+                if (phase == STEP_PLAY_TURN && checkForWin(&leftState, leftState.currentPlayerIndex))
+                {
+                    turn = config->maxTurns; // game over
+                    break;
+                }
+            }
+            turnsPlayed++;
+        }
+    }
+
+    config->reference->destroy(left);
+    config->candidate->destroy(right);
+    gameLogEnabled = logWasEnabled;
+
+    double elapsed = currentTime() - started;
+    if (!diverged)
+    {
+        printf("%s and %s agree on %llu games (%llu turns) in %.2f s: %.0f games/hour.\n", config->reference->name,
+               config->candidate->name, config->games, turnsPlayed, elapsed,
+               elapsed > 0 ? config->games * 3600.0 / elapsed : 0.0);
+    }
+    return !diverged;
+}
+
+bool replayReproducer(const char *path, const EngineOps *reference, const EngineOps *candidate)
+{
+    unsigned char header[9];
+    unsigned char record[STATE_RECORD_SIZE];
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    bool complete = fread(header, 1, sizeof(header), file) == sizeof(header) &&
+                    fread(record, 1, sizeof(record), file) == sizeof(record);
+    fclose(file);
+
+    GameState state;
+    if (!complete || memcmp(header, REPRODUCER_MAGIC, 8) != 0 || header[8] > STEP_ADVANCE_TURN ||
+        !deserializeGameState(record, &state))
+    {
+        fprintf(stderr, "%s is not a lockstep reproducer.\n", path);
+        return false;
+    }
+
+    LockstepConfig config;
+    initLockstepConfig(&config);
+    config.reference = reference;
+    config.candidate = candidate;
+    StepPhase phase = (StepPhase)header[8];
+
+    bool logWasEnabled = gameLogEnabled;
+    gameLogEnabled = false;
+    bool diverges = stillDiverges(&config, &state, phase);
+
+    printf("Replaying %s from %s: %s.\n", phaseNames[phase], path, diverges ? "engines diverge" : "engines agree");
+    if (diverges)
+    {
+        reportDivergence(&config, &state, phase);
+    }
+    gameLogEnabled = logWasEnabled;
+    return !diverges;
+}
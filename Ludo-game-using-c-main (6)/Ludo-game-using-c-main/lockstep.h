@@ -0,0 +1,45 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "types.h"
+#include <stdio.h>
+
+// Lockstep games are short by default so that quirks near the opening and in
+// scrambled positions get covered many times over
+#define LOCKSTEP_DEFAULT_MAX_TURNS 1000
+#define LOCKSTEP_DEFAULT_REPRODUCER "lockstep.repro"
+
+// An engine owns its own representation of a game. load and store convert
+// from and to GameState; playTurn and advanceTurn have the same contract as
+// the functions of the same name in game_logic.c, random stream included.
+typedef struct
+{
+    const char *name;
+    const char *description;
+    void *(*create)(void);
+    void (*destroy)(void *engine);
+    void (*load)(void *engine, const GameState *state);
+    void (*store)(void *engine, GameState *state);
+    int (*playTurn)(void *engine);
+    void (*advanceTurn)(void *engine);
+} EngineOps;
+
+typedef struct
+{
+    const EngineOps *reference;
+    const EngineOps *candidate;
+    unsigned long long seed;
+    unsigned long long games;
+    int maxTurns;
+    bool scramble; // start from random positions instead of the opening
+    const char *reproducerPath;
+} LockstepConfig;
+
+const EngineOps *findEngine(const char *name);
+void listEngines(FILE *out);
+
+void initLockstepConfig(LockstepConfig *config);
+bool runLockstep(const LockstepConfig *config);
+bool replayReproducer(const char *path, const EngineOps *reference, const EngineOps *candidate);
+
+#endif // LOCKSTEP_H
@@ -1,16 +1,106 @@
 #include "types.h"
+#include "batch.h"
+#include "eval.h"
+#include "lockstep.h"
+#include "rare.h"
+#include "render.h"
+#include "ring.h"
+#include "shard.h"
+#include "sim.h"
+#include "strategy.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 // Declare functions from game_logic.c
-extern void initializeGame(GameState *game);
-extern int rollDice();
 extern void movePiece(GameState *game, int playerIndex, int pieceIndex, int steps);
 extern void printGameStatus(GameState *game);
-extern const char* getColorName(PlayerColor color);
 
-int main() {
+typedef enum {
+    MODE_PLAY,
+    MODE_SIMULATE,
+    MODE_COORDINATOR,
+    MODE_WORKER,
+    MODE_MERGE,
+    MODE_REPORT,
+    MODE_LOCKSTEP,
+    MODE_REPLAY,
+    MODE_MAKE_CORPUS,
+    MODE_EVALUATE,
+    MODE_ARENA_BENCH,
+    MODE_WATCH,
+    MODE_RING_BENCH,
+    MODE_RARE
+} RunMode;
+
+static void printUsage(const char *program)
+{
+    printf("Usage: %s [--board] [--fps N] [--skip N] [--seed N] [--strategy SEAT=NAME]... [--ring NAME]\n", program);
+    printf("       %s --simulate --games N [--first N] [--threads N] [--nodes N] [--pages MODE] [--in-flight N]\n", program);
+    printf("                [study options] [--out FILE]\n");
+    printf("       %s --arena-bench [--games N] [--threads N] [--in-flight N] [--pages MODE]\n", program);
+    printf("       %s --watch NAME [--consumer text|stats]\n", program);
+    printf("       %s --ring-bench [--events N] [--readers N] [--rate N] [--ring-size N]\n", program);
+    printf("       %s --rare EVENT [--games N] [--seed N] [--horizon N] [--length N] [--bias X]\n", program);
+    printf("       %s --coordinator (--socket PATH | --dir PATH) --games N [--shard-size N]\n", program);
+    printf("                [--spawn N] [--timeout SEC] [study options] [--out FILE]\n");
+    printf("       %s --worker (--socket PATH | --dir PATH)\n", program);
+    printf("       %s --merge OUT IN...\n", program);
+    printf("       %s --report FILE\n", program);
+    printf("       %s --lockstep [--engine NAME] [--games N] [--seed N] [--max-turns N] [--scramble] [--repro FILE]\n", program);
+    printf("       %s --replay FILE [--engine NAME]\n", program);
+    printf("       %s --make-corpus FILE --games N [--seed N] [--sample N] [--max-turns N]\n", program);
+    printf("       %s --evaluate CORPUS [--threads N] [--rollouts N] [--window N] [--seed N] [--max-turns N] [--out FILE]\n", program);
+    printf("  --board        draw the board in place instead of printing the game log\n");
+    printf("  --fps N        draw at most N board frames per second\n");
+    printf("  --skip N       fast-forward: draw one board frame every N + 1 turns\n");
+    printf("  --seed N       game seed, or study seed for batch runs\n");
+    printf("  --max-turns N  stop games after N turns (default %d, 0 for no limit in studies)\n", DEFAULT_MAX_TURNS);
+    printf("  --max-stall N  stop games after N turns without a piece reaching home (default %d)\n",
+           DEFAULT_MAX_STALL_TURNS);
+    printf("  --cycle-window N, --cycle-repeats N\n");
+    printf("                 stop games whose position recurs N times within the last turns (default %d in %d);\n",
+           DEFAULT_CYCLE_REPEATS, DEFAULT_CYCLE_WINDOW);
+    printf("                 one position per round is sampled, so cycles seen only at other seats are missed\n");
+    printf("  --strategy SEAT=NAME\n");
+    printf("                 let SEAT (a colour or 0-3) play a built-in strategy or one loaded from\n");
+    printf("                 path.so[:symbol] (default symbol %s); studies record it for their workers\n",
+           DEFAULT_STRATEGY_SYMBOL);
+    printf("  --records      keep one record per game in the results\n");
+    printf("  --spawn N      start N local workers from the coordinator\n");
+    printf("  --timeout SEC  hand shards out again after SEC seconds (default %.0f)\n", DEFAULT_SHARD_TIMEOUT);
+    printf("  --engine NAME  engine checked against the reference in lockstep (default reference)\n");
+    printf("  --scramble     start lockstep games from random positions\n");
+    printf("  --repro FILE   where lockstep writes the reproducer (default %s)\n", LOCKSTEP_DEFAULT_REPRODUCER);
+    printf("  --sample N     keep every Nth decision of each game in the corpus (default %d)\n", DEFAULT_CORPUS_SAMPLE);
+    printf("  --threads N    evaluation threads (default: one per processor), or simulation workers\n");
+    printf("  --nodes N      pin simulation workers to N memory nodes, simulated if the machine has fewer\n");
+    printf("  --pages MODE   simulation arena pages: small, thp or huge (default huge, falls back to thp)\n");
+    printf("  --in-flight N  games each simulation worker steps in turn (default %d)\n", DEFAULT_GAMES_IN_FLIGHT);
+    printf("  --ring NAME    also publish the game's events to shared memory ring NAME (e.g. %s)\n",
+           DEFAULT_RING_NAME);
+    printf("  --ring-size N  ring slots, a power of two (default %d)\n", DEFAULT_RING_SLOTS);
+    printf("  --consumer K   text narrates the events, stats summarises them at the end (default text)\n");
+    printf("  --readers N    largest number of reader processes to benchmark (default %d)\n",
+           DEFAULT_RING_BENCH_READERS);
+    printf("  --events N     events published per benchmark run (default %d)\n", DEFAULT_RING_BENCH_EVENTS);
+    printf("  --rate N       publish N events per second in the benchmark (default: flat out)\n");
+    printf("  --rare EVENT   estimate the chance of sixes (N sixes in one turn), chain (N captures from one\n");
+    printf("                 roll) or kotuwa (N Pita-Kotuwa -> Kotuwa redirects) by importance sampling\n");
+    printf("  --horizon N    turns within which the rare event has to happen (default 8, 100, 200)\n");
+    printf("  --length N     N of the rare event (default 5 sixes, 5 captures, 2 redirects)\n");
+    printf("  --bias X       share of each tilted draw given to the rare event, 0 to 1 (default 0.8, 0.6, 0.8)\n");
+    printf("  --rollouts N   rollouts per candidate move (default %d)\n", DEFAULT_EVAL_ROLLOUTS);
+    printf("  --window N     positions mapped and buffered at a time (default %d)\n", DEFAULT_EVAL_WINDOW);
+    printf("Engines:\n");
+    listEngines(stdout);
+    printf("Strategies:\n");
+    listStrategies(stdout);
+}
+
+static int playGame(bool boardMode, int maxFps, int frameSkip, unsigned long long seed, const RunawayLimits *limits,
+                    const char *ringName, unsigned long long ringSlots) {
 
      // Redirect stdout to a file
     // FILE *outputFile = freopen("game_output.txt", "w", stdout);
@@ -19,128 +109,396 @@ int main() {
     //     return 1;
     // }
 
-    srand(time(NULL));  // Initialize random seed
-    
     GameState game;
     initializeGame(&game);
-    
-    printf("LUDO-CS Game Simulation\n\n");
-    
-    // Determine first player
-    int highestRoll = 0;
-    int firstPlayer = 0;
-    for (int i = 0; i < NUM_PLAYERS; i++) {
-        int roll = rollDice();
-        printf("%s rolls %d\n", getColorName(game.players[i].color), roll);
-        if (roll > highestRoll) {
-            highestRoll = roll;
-            firstPlayer = i;
+    seedGame(&game, seed);
+    RunawayDetector detector;
+    initRunawayDetector(&detector, limits);
+
+    EventRing ring;
+    if (ringName != NULL) {
+        if (!createEventRing(&ring, ringName, ringSlots)) {
+            freeRunawayDetector(&detector);
+            return 1;
         }
+        setEventSink(eventRingSink, &ring);
+    }
+
+    BoardRenderer renderer;
+    if (boardMode) {
+        // The board replaces the narration, which would scroll it away
+        gameLogEnabled = false;
+        initRenderer(&renderer, stdout, maxFps, frameSkip);
     }
+    char status[FRAME_COLS];
     
-    printf("%s player has the highest roll and will begin the game.\n", 
-           getColorName(game.players[firstPlayer].color));
+    gameLog("LUDO-CS Game Simulation\n\n");
     
-    game.currentPlayerIndex = firstPlayer;
+    // Determine first player
+    chooseFirstPlayer(&game);
     
     // Main game loop
     while (1) {
         Player *currentPlayer = &game.players[game.currentPlayerIndex];
-        int roll = rollDice();
-        
-        printf("\n%s player rolled %d.\n", getColorName(currentPlayer->color), roll);
-
-        while (roll == 6) {
-        bool pieceMoved = false;
-
-        // Try to move a piece out of the base
-        for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-            if (currentPlayer->pieces[i].isBase) {
-                movePiece(&game, game.currentPlayerIndex, i, roll);
-                pieceMoved = true;
-                break;
-            }
-        }
-
-        // If no piece was moved out of the base, move a piece already on the board
-        if (!pieceMoved) {
-            for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-                if (!currentPlayer->pieces[i].isBase && !currentPlayer->pieces[i].isHome) {
-                    movePiece(&game, game.currentPlayerIndex, i, roll);
-                    break;
-                }
-            }
-        }
-
-        roll = rollDice();  // Roll again if a 6 was rolled
-        printf("%s player rolled %d.\n", getColorName(currentPlayer->color), roll);
-    }
-
-     if (roll == 6) {
-        game.consecutiveSixesCount[game.currentPlayerIndex]++; 
-
-        if (game.consecutiveSixesCount[game.currentPlayerIndex] == 3) {
-            // Player has rolled three sixes in a row
-            breakBlockade(&game, game.currentPlayerIndex);
-            game.consecutiveSixesCount[game.currentPlayerIndex] = 0; // Reset the counter 
-        }
-    } else {
-        game.consecutiveSixesCount[game.currentPlayerIndex] = 0; // Reset if not a six
-    } 
-        
-        // Implement player behavior and move pieces here
-        // bool moved = false;
-    // for (int i = 0; i < PIECES_PER_PLAYER; i++) {
-    //     if (!currentPlayer->pieces[i].isHome) {
-    //         movePiece(&game, game.currentPlayerIndex, i, roll);
-    //         moved = true;
-    //         break;
-    //     }
-    // }
-
-    
-        // This is where you'll need to add the logic for each player's behavior
-        
-        
-         implementPlayerBehaviors(&game, roll, game.currentPlayerIndex);
-        
+        int roll = playTurn(&game);
         
         // Check for win condition
         if (currentPlayer->piecesInHome == PIECES_PER_PLAYER) {
+            if (boardMode) {
+                snprintf(status, sizeof(status), "%s wins", getColorName(currentPlayer->color));
+                finishRenderer(&renderer, &game, status);
+            }
             printf("%s player wins!!!\n", getColorName(currentPlayer->color));
+            publishGameEvent(&game, (GameEvent){.type = EVENT_GAME_OVER, .player = game.currentPlayerIndex,
+                                                .value = OUTCOME_FINISHED});
             break;
         }
         
-        printGameStatus(&game);
+        if (boardMode) {
+            snprintf(status, sizeof(status), "%s rolled %d", getColorName(currentPlayer->color), roll);
+            renderFrame(&renderer, &game, status);
+        } else {
+            printGameStatus(&game);
+        }
         
         // Move to next player
-        game.currentPlayerIndex = (game.currentPlayerIndex + 1) % NUM_PLAYERS;
-        // Check if the round is complete (i.e., all players have taken their turns)
-        if (game.currentPlayerIndex == 0) {
-            game.roundCount++;
-            // Update mystery cell if needed
-            if (game.roundCount % 4 == 0) {
-                // Implement mystery cell logic here
-                if (game.roundCount % 4 == 0) {
-    game.mysteryCell.position = rand() % BOARD_SIZE; // Randomly place the mystery cell
-    game.mysteryCell.roundsLeft = 3; // It will stay for 3 rounds
-    printf("A mystery cell has appeared at position %d!\n", game.mysteryCell.position);
-} else if (game.mysteryCell.roundsLeft > 0) {
-    game.mysteryCell.roundsLeft--;
-    if (game.mysteryCell.roundsLeft == 0) {
-        game.mysteryCell.position = -1; // Remove mystery cell
-        printf("The mystery cell has disappeared.\n");
-    }
-}
+        advanceTurn(&game);
+
+        GameOutcome outcome;
+        if (runawayDetected(&detector, &game, &outcome)) {
+            snprintf(status, sizeof(status), "Stopped after %d turns (%s)", detector.turns, getOutcomeName(outcome));
+            if (boardMode) {
+                finishRenderer(&renderer, &game, status);
             }
+            printf("%s.\n", status);
+            publishGameEvent(&game, (GameEvent){.type = EVENT_GAME_OVER, .player = NO_SEAT, .value = outcome});
+            break;
         }
     }
+    freeRunawayDetector(&detector);
+    if (ringName != NULL) {
+        // Watchers finish with the game, and late ones can still attach until Enter
+        setEventSink(NULL, NULL);
+        finishEventRing(&ring);
+    }
     
     // Wait for user input before closing
     printf("\nPress Enter to exit...");
     getchar();
+    if (ringName != NULL) {
+        closeEventRing(&ring);
+    }
 
     //  fclose(outputFile);
     
     return 0;
 }
+
+static int finishStudy(const SimResult *result, const char *outputPath)
+{
+    printSimResult(result);
+    if (outputPath != NULL && !writeSimResult(outputPath, result)) {
+        return 1;
+    }
+    return 0;
+}
+
+static int compareFirstGames(const void *a, const void *b)
+{
+    const SimResult *left = a;
+    const SimResult *right = b;
+    return (left->firstGame > right->firstGame) - (left->firstGame < right->firstGame);
+}
+
+// Inputs may come in any order; mergeSimResults wants them by first game
+static int mergeResultFiles(const char *outputPath, char *inputs[], int inputCount)
+{
+    SimResult parts[256];
+    SimResult merged;
+    memset(&merged, 0, sizeof(merged));
+
+    int partCount = 0;
+    bool readAll = true;
+    while (partCount < inputCount && readAll) {
+        readAll = readSimResult(inputs[partCount], &parts[partCount]);
+        partCount += readAll;
+    }
+    qsort(parts, partCount, sizeof(SimResult), compareFirstGames);
+
+    bool mergedAll = readAll;
+    for (int i = 0; i < partCount; i++) {
+        mergedAll = mergedAll && mergeSimResults(&merged, &parts[i]);
+        freeSimResult(&parts[i]);
+    }
+
+    int status = mergedAll ? finishStudy(&merged, outputPath) : 1;
+    freeSimResult(&merged);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+
+    RunMode mode = MODE_PLAY;
+    bool boardMode = false;
+    int maxFps = 0;
+    int frameSkip = 0;
+    bool seedGiven = false;
+    unsigned long long firstGame = 0;
+    const char *outputPath = NULL;
+    char *inputs[256];
+    int inputCount = 0;
+
+    bool maxTurnsGiven = false;
+
+    StudyConfig study;
+    initStudyConfig(&study);
+    LockstepConfig lockstep;
+    initLockstepConfig(&lockstep);
+    EvalConfig evaluation;
+    initEvalConfig(&evaluation);
+    int sampleEvery = DEFAULT_CORPUS_SAMPLE;
+    BatchConfig batch;
+    initBatchConfig(&batch);
+    bool batchGiven = false;
+    const char *ringName = NULL;
+    ConsumerKind consumer = CONSUMER_TEXT;
+    RingBenchConfig ringBench;
+    initRingBenchConfig(&ringBench);
+    RareConfig rare;
+    initRareConfig(&rare);
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--board") == 0) {
+            boardMode = true;
+        } else if (strcmp(argv[i], "--fps") == 0 && hasValue) {
+            maxFps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--skip") == 0 && hasValue) {
+            frameSkip = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            study.sim.studySeed = strtoull(argv[++i], NULL, 10);
+            seedGiven = true;
+        } else if (strcmp(argv[i], "--simulate") == 0) {
+            mode = MODE_SIMULATE;
+        } else if (strcmp(argv[i], "--coordinator") == 0) {
+            mode = MODE_COORDINATOR;
+        } else if (strcmp(argv[i], "--worker") == 0) {
+            mode = MODE_WORKER;
+        } else if (strcmp(argv[i], "--merge") == 0 && hasValue) {
+            mode = MODE_MERGE;
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--report") == 0 && hasValue) {
+            mode = MODE_REPORT;
+            inputs[inputCount++] = argv[++i];
+        } else if (strcmp(argv[i], "--games") == 0 && hasValue) {
+            study.games = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--first") == 0 && hasValue) {
+            firstGame = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-turns") == 0 && hasValue) {
+            study.sim.limits.maxTurns = atoi(argv[++i]);
+            maxTurnsGiven = true;
+        } else if (strcmp(argv[i], "--max-stall") == 0 && hasValue) {
+            study.sim.limits.maxStallTurns = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cycle-window") == 0 && hasValue) {
+            study.sim.limits.cycleWindow = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cycle-repeats") == 0 && hasValue) {
+            study.sim.limits.cycleRepeats = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--strategy") == 0 && hasValue) {
+            if (!assignStrategy(argv[++i])) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--records") == 0) {
+            study.sim.keepRecords = true;
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--shard-size") == 0 && hasValue) {
+            study.shardSize = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--socket") == 0 && hasValue) {
+            study.socketPath = argv[++i];
+        } else if (strcmp(argv[i], "--dir") == 0 && hasValue) {
+            study.directory = argv[++i];
+        } else if (strcmp(argv[i], "--spawn") == 0 && hasValue) {
+            study.spawnWorkers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--timeout") == 0 && hasValue) {
+            study.timeoutSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--lockstep") == 0) {
+            mode = MODE_LOCKSTEP;
+        } else if (strcmp(argv[i], "--replay") == 0 && hasValue) {
+            mode = MODE_REPLAY;
+            inputs[inputCount++] = argv[++i];
+        } else if (strcmp(argv[i], "--engine") == 0 && hasValue) {
+            lockstep.candidate = findEngine(argv[++i]);
+            if (lockstep.candidate == NULL) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--scramble") == 0) {
+            lockstep.scramble = true;
+        } else if (strcmp(argv[i], "--repro") == 0 && hasValue) {
+            lockstep.reproducerPath = argv[++i];
+        } else if (strcmp(argv[i], "--make-corpus") == 0 && hasValue) {
+            mode = MODE_MAKE_CORPUS;
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--evaluate") == 0 && hasValue) {
+            mode = MODE_EVALUATE;
+            inputs[inputCount++] = argv[++i];
+        } else if (strcmp(argv[i], "--sample") == 0 && hasValue) {
+            sampleEvery = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            evaluation.threads = atoi(argv[++i]);
+            batch.threads = evaluation.threads;
+            batchGiven = true;
+        } else if (strcmp(argv[i], "--nodes") == 0 && hasValue) {
+            batch.nodes = atoi(argv[++i]);
+            batchGiven = true;
+        } else if (strcmp(argv[i], "--pages") == 0 && hasValue) {
+            if (!parsePageMode(argv[++i], &batch.pages)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            batchGiven = true;
+        } else if (strcmp(argv[i], "--in-flight") == 0 && hasValue) {
+            batch.gamesInFlight = atoi(argv[++i]);
+            batchGiven = true;
+        } else if (strcmp(argv[i], "--arena-bench") == 0) {
+            mode = MODE_ARENA_BENCH;
+        } else if (strcmp(argv[i], "--ring") == 0 && hasValue) {
+            ringName = argv[++i];
+        } else if (strcmp(argv[i], "--ring-size") == 0 && hasValue) {
+            ringBench.slotCount = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--watch") == 0 && hasValue) {
+            mode = MODE_WATCH;
+            ringName = argv[++i];
+        } else if (strcmp(argv[i], "--consumer") == 0 && hasValue) {
+            if (!parseConsumerKind(argv[++i], &consumer)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--ring-bench") == 0) {
+            mode = MODE_RING_BENCH;
+        } else if (strcmp(argv[i], "--readers") == 0 && hasValue) {
+            ringBench.maxReaders = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--events") == 0 && hasValue) {
+            ringBench.events = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--rate") == 0 && hasValue) {
+            ringBench.rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rare") == 0 && hasValue) {
+            mode = MODE_RARE;
+            if (!parseRareEvent(argv[++i], &rare.event)) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--horizon") == 0 && hasValue) {
+            rare.horizon = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--length") == 0 && hasValue) {
+            rare.length = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bias") == 0 && hasValue) {
+            rare.bias = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rollouts") == 0 && hasValue) {
+            evaluation.rollouts = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--window") == 0 && hasValue) {
+            evaluation.windowPositions = strtoull(argv[++i], NULL, 10);
+        } else if (mode == MODE_MERGE && argv[i][0] != '-' && inputCount < 256) {
+            inputs[inputCount++] = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    recordSeatStrategies(&study.sim);
+
+    // Lockstep, corpus games and rollouts need a turn bound to stop at
+    bool needsTurnBound = mode == MODE_LOCKSTEP || mode == MODE_MAKE_CORPUS || mode == MODE_EVALUATE;
+    if (needsTurnBound && maxTurnsGiven && study.sim.limits.maxTurns <= 0) {
+        fprintf(stderr, "--max-turns must be above 0 for --lockstep, --make-corpus and --evaluate.\n");
+        return 1;
+    }
+
+    bool needsTransport = mode == MODE_COORDINATOR || mode == MODE_WORKER;
+    if (needsTransport && (study.socketPath == NULL) == (study.directory == NULL)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    switch (mode) {
+        case MODE_PLAY:
+            return playGame(boardMode, maxFps, frameSkip, seedGiven ? study.sim.studySeed : (unsigned long long)time(NULL),
+                            &study.sim.limits, ringName, ringBench.slotCount);
+
+        case MODE_SIMULATE: {
+            SimResult result;
+            if (batchGiven) {
+                BatchReport report;
+                if (!runBatch(&study.sim, firstGame, study.games, &batch, &result, &report)) {
+                    return 1;
+                }
+                fprintf(stderr, "Played %llu games on %d threads over %d%s nodes with %s pages in %.2f s.\n",
+                        study.games, report.threads, report.nodes, report.simulatedNodes ? " simulated" : "",
+                        getPageModeName(report.pages), report.seconds);
+            } else {
+                runSimulation(&study.sim, firstGame, study.games, &result);
+            }
+            int status = finishStudy(&result, outputPath);
+            freeSimResult(&result);
+            return status;
+        }
+
+        case MODE_COORDINATOR: {
+            SimResult result;
+            bool completed = runCoordinator(&study, &result);
+            int status = completed ? finishStudy(&result, outputPath) : 1;
+            freeSimResult(&result);
+            return status;
+        }
+
+        case MODE_WORKER:
+            return runWorker(study.socketPath, study.directory) ? 0 : 1;
+
+        case MODE_MERGE:
+            return mergeResultFiles(outputPath, inputs, inputCount);
+
+        case MODE_REPORT:
+            return mergeResultFiles(NULL, inputs, inputCount);
+
+        case MODE_LOCKSTEP:
+            lockstep.seed = study.sim.studySeed;
+            if (study.games > 0) {
+                lockstep.games = study.games;
+            }
+            if (maxTurnsGiven) {
+                lockstep.maxTurns = study.sim.limits.maxTurns;
+            }
+            return runLockstep(&lockstep) ? 0 : 1;
+
+        case MODE_REPLAY:
+            return replayReproducer(inputs[0], lockstep.reference, lockstep.candidate) ? 0 : 1;
+
+        case MODE_MAKE_CORPUS:
+            return writeCorpus(outputPath, study.games, study.sim.studySeed, sampleEvery > 0 ? sampleEvery : 1,
+                               maxTurnsGiven ? study.sim.limits.maxTurns : DEFAULT_CORPUS_MAX_TURNS) ? 0 : 1;
+
+        case MODE_EVALUATE:
+            evaluation.seed = study.sim.studySeed;
+            if (maxTurnsGiven) {
+                evaluation.maxTurns = study.sim.limits.maxTurns;
+            }
+            return evaluateCorpus(inputs[0], outputPath, &evaluation) ? 0 : 1;
+
+        case MODE_ARENA_BENCH:
+            return runArenaBenchmark(&study.sim, study.games > 0 ? study.games : DEFAULT_BENCH_GAMES, &batch) ? 0 : 1;
+
+        case MODE_WATCH:
+            return watchEventRing(ringName, consumer) ? 0 : 1;
+
+        case MODE_RING_BENCH:
+            return runRingBenchmark(&ringBench) ? 0 : 1;
+
+        case MODE_RARE:
+            rare.seed = study.sim.studySeed;
+            if (study.games > 0) {
+                rare.games = study.games;
+            }
+            return runRareEstimate(&rare) ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,343 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "rare.h"
+#include "events.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_OUTCOMES 6
+#define UNIT_BITS 30
+#define PITA_KOTUWA 2
+
+typedef struct
+{
+    const char *name;
+    const char *description;
+    int defaultLength;
+    int defaultHorizon;
+    double defaultBias;
+} RareEventInfo;
+
+// Defaults put each event around 1e-4 to 1e-3, where plain Monte Carlo
+// needs millions of games for a usable error bar
+static const RareEventInfo rareEvents[RARE_EVENT_COUNT] = {
+    {"sixes", "sixes in a row in one turn", 5, 8, 0.8},
+    {"chain", "captures from one roll", 5, 100, 0.6},
+    {"kotuwa", "Pita-Kotuwa -> Kotuwa redirects", 2, 200, 0.8},
+};
+
+// One game's progress towards the event and the likelihood ratio of the
+// draws made so far
+typedef struct
+{
+    RareEventKind event;
+    int length;
+    double bias;
+    int sixesInRow;
+    int capturesThisRoll;
+    int redirects;
+    bool hit;
+    double logWeight;
+} RareRun;
+
+// Mean and variance of the per-game estimates (Welford)
+typedef struct
+{
+    unsigned long long games;
+    unsigned long long hits;
+    double mean;
+    double squares;
+    double seconds;
+} RareTally;
+
+void initRareConfig(RareConfig *config)
+{
+    config->event = RARE_SIXES;
+    config->length = 0;
+    config->horizon = 0;
+    config->games = DEFAULT_RARE_GAMES;
+    config->seed = 1;
+    config->bias = -1;
+}
+
+bool parseRareEvent(const char *name, RareEventKind *event)
+{
+    for (int i = 0; i < RARE_EVENT_COUNT; i++)
+    {
+        if (strcmp(rareEvents[i].name, name) == 0)
+        {
+            *event = (RareEventKind)i;
+            return true;
+        }
+    }
+    fprintf(stderr, "Unknown rare event %s (sixes, chain or kotuwa).\n", name);
+    return false;
+}
+
+static double currentTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// The engine narrates everything the events are made of
+static void watchEvents(void *context, const GameEvent *event)
+{
+    RareRun *run = context;
+
+    switch (event->type)
+    {
+    case EVENT_ROLL:
+        run->capturesThisRoll = 0;
+        run->sixesInRow = event->value == 6 ? run->sixesInRow + 1 : 0;
+        run->hit |= run->event == RARE_SIXES && run->sixesInRow >= run->length;
+        break;
+    case EVENT_CAPTURE:
+        run->capturesThisRoll++;
+        run->hit |= run->event == RARE_CAPTURE_CHAIN && run->capturesThisRoll >= run->length;
+        break;
+    case EVENT_SENT_TO_KOTUWA:
+        run->redirects++;
+        run->hit |= run->event == RARE_KOTUWA && run->redirects >= run->length;
+        break;
+    default:
+        break;
+    }
+}
+
+// Track cell movePiece would put the piece on, -1 if it would not land on
+// the track
+static int landingCell(const GameState *game, int playerIndex, int pieceIndex, int steps)
+{
+    const Piece *piece = &game->players[playerIndex].pieces[pieceIndex];
+    int startingPosition = (playerIndex * 13 + 2) % BOARD_SIZE;
+    if (piece->isBase)
+    {
+        return steps == 6 ? startingPosition : -1;
+    }
+    if (piece->isHome)
+    {
+        return -1;
+    }
+
+    int newPosition = piece->direction == CLOCKWISE ? (piece->position + steps) % BOARD_SIZE
+                                                    : (piece->position - steps + BOARD_SIZE) % BOARD_SIZE;
+    return newPosition == startingPosition && piece->captures > 0 ? -1 : newPosition; // -1: into the home path
+}
+
+static bool holdsOpponent(const GameState *game, int playerIndex, int cell)
+{
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        for (int j = 0; i != playerIndex && j < PIECES_PER_PLAYER; j++)
+        {
+            const Piece *other = &game->players[i].pieces[j];
+            if (!other->isBase && !other->isHome && other->position == cell)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool rollWouldCapture(const GameState *game, int playerIndex, int pieceIndex, int steps)
+{
+    int cell = landingCell(game, playerIndex, pieceIndex, steps);
+    return cell >= 0 && holdsOpponent(game, playerIndex, cell);
+}
+
+// Proposal for one draw: a mixture of the fair distribution and the outcomes
+// that lead towards the event, so that every outcome keeps some chance and
+// the likelihood ratio stays bounded. Returns false for draws left fair.
+static bool proposeDraw(const RareRun *run, const GameState *game, DrawKind kind, int playerIndex, int pieceIndex,
+                        int outcomes, double *proposal)
+{
+    bool favoured[MAX_OUTCOMES] = {false};
+    int favouredCount = 0;
+
+    // Draws left in the turn after the event do not change the answer, and
+    // tilting them would only add noise to the weight
+    if (run->hit)
+    {
+        return false;
+    }
+    if (run->event == RARE_SIXES)
+    {
+        // The streak's first six comes at the fair rate, the rest are tilted
+        favoured[5] = kind == DRAW_TURN_ROLL && run->sixesInRow > 0;
+        favouredCount = favoured[5];
+    }
+    else if (run->event == RARE_CAPTURE_CHAIN && kind == DRAW_BONUS_ROLL)
+    {
+        // Only bonus rolls: tilting every turn roll over the horizon makes the
+        // weights heavy-tailed, and a chain's first capture is common enough
+        for (int face = 0; face < outcomes; face++)
+        {
+            favoured[face] = rollWouldCapture(game, playerIndex, pieceIndex, face + 1);
+            favouredCount += favoured[face];
+        }
+    }
+    else if (run->event == RARE_KOTUWA && kind == DRAW_MYSTERY_DESTINATION)
+    {
+        favoured[PITA_KOTUWA] = true;
+        favouredCount = 1;
+    }
+
+    if (favouredCount == 0 || favouredCount == outcomes)
+    {
+        return false;
+    }
+    for (int i = 0; i < outcomes; i++)
+    {
+        proposal[i] = (1 - run->bias) / outcomes + (favoured[i] ? run->bias / favouredCount : 0);
+    }
+    return true;
+}
+
+static int drawTilted(void *context, GameState *game, DrawKind kind, int playerIndex, int pieceIndex, int outcomes)
+{
+    RareRun *run = context;
+    double proposal[MAX_OUTCOMES];
+    if (outcomes > MAX_OUTCOMES || !proposeDraw(run, game, kind, playerIndex, pieceIndex, outcomes, proposal))
+    {
+        return randomInt(game, outcomes);
+    }
+
+    double unit = (randomInt(game, 1 << UNIT_BITS) + 0.5) / (double)(1 << UNIT_BITS);
+    int outcome = 0;
+    double cumulative = proposal[0];
+    while (outcome < outcomes - 1 && unit >= cumulative)
+    {
+        cumulative += proposal[++outcome];
+    }
+    run->logWeight += log(1.0 / outcomes) - log(proposal[outcome]);
+    return outcome;
+}
+
+// Likelihood ratio of the game if the event happened within the horizon, 0
+// otherwise; 1 or 0 when nothing is tilted
+static double playRareGame(RareRun *run, const RareConfig *config, unsigned long long gameIndex)
+{
+    run->sixesInRow = 0;
+    run->capturesThisRoll = 0;
+    run->redirects = 0;
+    run->hit = false;
+    run->logWeight = 0;
+
+    GameState game;
+    initializeGame(&game);
+    seedGame(&game, config->seed * 0xD1B54A32D192ED03ULL + gameIndex);
+    chooseFirstPlayer(&game);
+
+    for (int turn = 0; turn < config->horizon; turn++)
+    {
+        playTurn(&game);
+        if (run->hit || checkForWin(&game, game.currentPlayerIndex))
+        {
+            break;
+        }
+        advanceTurn(&game);
+    }
+    return run->hit ? exp(run->logWeight) : 0;
+}
+
+static void runTally(const RareConfig *config, RareRun *run, bool tilted, RareTally *tally)
+{
+    memset(tally, 0, sizeof(*tally));
+    setEventSink(watchEvents, run);
+    setDrawHook(tilted ? drawTilted : NULL, run);
+    double started = currentTime();
+
+    for (unsigned long long g = 0; g < config->games; g++)
+    {
+        double value = playRareGame(run, config, g);
+        tally->hits += run->hit;
+        tally->games++;
+        double delta = value - tally->mean;
+        tally->mean += delta / tally->games;
+        tally->squares += delta * (value - tally->mean);
+    }
+
+    tally->seconds = currentTime() - started;
+    setDrawHook(NULL, NULL);
+    setEventSink(NULL, NULL);
+}
+
+static void printTally(const char *method, double bias, const RareTally *tally)
+{
+    double variance = tally->games > 1 ? tally->squares / (tally->games - 1) : 0;
+    double error = sqrt(variance / (tally->games > 0 ? tally->games : 1));
+    printf("%-10s %5.2f %10llu %12.4e %12.4e ", method, bias, tally->hits, tally->mean, error);
+    if (tally->mean > 0)
+    {
+        // Plain Monte Carlo's variance per game is p(1 - p)
+        double plainGames = tally->mean * (1 - tally->mean) / (error * error);
+        printf("%8.2f%%  [%.4e, %.4e] %14.3g", 100 * error / tally->mean, tally->mean - 1.96 * error,
+               tally->mean + 1.96 * error, error > 0 ? plainGames : 0.0);
+    }
+    else
+    {
+        printf("%9s  %-26s %14s", "-", "no hits", "-");
+    }
+    printf(" %8.2f\n", tally->seconds);
+}
+
+bool runRareEstimate(const RareConfig *config)
+{
+    RareConfig run = *config;
+    const RareEventInfo *info = &rareEvents[run.event];
+    if (run.length <= 0)
+    {
+        run.length = info->defaultLength;
+    }
+    if (run.horizon <= 0)
+    {
+        run.horizon = info->defaultHorizon;
+    }
+    if (run.bias < 0)
+    {
+        run.bias = info->defaultBias;
+    }
+    if (run.bias >= 1 || run.games == 0)
+    {
+        fprintf(stderr, "The bias must be below 1 and the games above 0.\n");
+        return false;
+    }
+
+    RareRun state;
+    memset(&state, 0, sizeof(state));
+    state.event = run.event;
+    state.length = run.length;
+    state.bias = run.bias;
+
+    bool logWasEnabled = gameLogEnabled;
+    gameLogEnabled = false;
+    RareTally tilted, plain;
+    runTally(&run, &state, true, &tilted);
+    runTally(&run, &state, false, &plain);
+    gameLogEnabled = logWasEnabled;
+
+    printf("P(%d %s within %d turns), %llu games per method, seed %llu\n", run.length, info->description,
+           run.horizon, run.games, run.seed);
+    printf("%-10s %5s %10s %12s %12s %9s  %-26s %14s %8s\n", "method", "bias", "hits", "estimate", "std error",
+           "rel error", "95% interval", "plain games*", "seconds");
+    printTally("importance", run.bias, &tilted);
+    printTally("plain", 0, &plain);
+    printf("* plain Monte Carlo games needed for the same standard error\n");
+
+    // Both methods played the same number of games, so their times compare directly
+    double tiltedVariance = tilted.games > 1 ? tilted.squares / (tilted.games - 1) : 0;
+    double probability = plain.mean > 0 ? plain.mean : tilted.mean;
+    double plainVariance = probability * (1 - probability);
+    if (tiltedVariance > 0 && plainVariance > 0 && tilted.seconds > 0)
+    {
+        printf("Variance per game: %.4e importance, %.4e plain: %.1fx fewer games, %.1fx less time.\n",
+               tiltedVariance, plainVariance, plainVariance / tiltedVariance,
+               plainVariance * plain.seconds / (tiltedVariance * tilted.seconds));
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef RARE_H
+#define RARE_H
+
+#include "types.h"
+
+#define DEFAULT_RARE_GAMES 100000
+
+typedef enum
+{
+    RARE_SIXES,         // length sixes in a row within one turn (the three-sixes rule)
+    RARE_CAPTURE_CHAIN, // length captures resolved from one roll, bonus rolls included
+    RARE_KOTUWA,        // a counterclockwise piece sent on from Pita-Kotuwa to Kotuwa
+    RARE_EVENT_COUNT
+} RareEventKind;
+
+// Estimates the probability that the event happens within the first
+// horizon turns of a game. Games stop at the first occurrence.
+typedef struct
+{
+    RareEventKind event;
+    int length;      // 0 takes the event's default
+    int horizon;     // turns; 0 takes the event's default
+    unsigned long long games;
+    unsigned long long seed;
+    double bias;     // share of each tilted draw given to the event, in [0, 1); below 0 takes the default
+} RareConfig;
+
+void initRareConfig(RareConfig *config);
+bool parseRareEvent(const char *name, RareEventKind *event);
+
+// Runs the biased estimator and plain Monte Carlo over the same games and
+// prints both estimates with their standard errors
+bool runRareEstimate(const RareConfig *config);
+
+#endif // RARE_H
@@ -0,0 +1,289 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "render.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Unchanged gaps shorter than this are re-sent instead of paying for a new
+// cursor escape sequence.
+#define RUN_MERGE_GAP 4
+
+// Home path lanes run from each starting cell towards the middle of the ring
+// (row step, column step) - Yellow, Blue, Red, Green
+static const int laneSteps[NUM_PLAYERS][2] = {{1, 0}, {0, -1}, {-1, 0}, {0, 1}};
+
+static double currentTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static char colorLetter(PlayerColor color)
+{
+    return getColorName(color)[0];
+}
+
+// Maps a track position onto the ring: 0 is the top left corner and the
+// track runs clockwise along the edges of a TRACK_SIDE x TRACK_SIDE square.
+static void trackCell(int position, int *row, int *col)
+{
+    if (position < TRACK_SIDE)
+    {
+        *row = 0;
+        *col = position;
+    }
+    else if (position < 2 * TRACK_SIDE - 2)
+    {
+        *row = position - (TRACK_SIDE - 1);
+        *col = TRACK_SIDE - 1;
+    }
+    else if (position < 3 * TRACK_SIDE - 2)
+    {
+        *row = TRACK_SIDE - 1;
+        *col = (TRACK_SIDE - 1) - (position - (2 * TRACK_SIDE - 2));
+    }
+    else
+    {
+        *row = BOARD_SIZE - position;
+        *col = 0;
+    }
+}
+
+static void putText(BoardRenderer *renderer, int row, int col, const char *text)
+{
+    for (int i = 0; text[i] != '\0' && col + i < FRAME_COLS; i++)
+    {
+        renderer->current[row][col + i] = text[i];
+    }
+}
+
+// Ring coordinates are offset by the status line
+static void putCell(BoardRenderer *renderer, int row, int col, const char *cell)
+{
+    putText(renderer, row + 1, col * CELL_WIDTH, cell);
+}
+
+static void drawTrack(BoardRenderer *renderer, GameState *game)
+{
+    for (int position = 0; position < BOARD_SIZE; position++)
+    {
+        char cell[3] = "..";
+        int count = 0;
+
+        for (int i = 0; i < NUM_PLAYERS; i++)
+        {
+            for (int j = 0; j < PIECES_PER_PLAYER; j++)
+            {
+                Piece *piece = &game->players[i].pieces[j];
+                if (!piece->isBase && !piece->isHome && piece->position == position)
+                {
+                    if (count == 0)
+                    {
+                        cell[0] = colorLetter(piece->color);
+                        cell[1] = '0' + piece->id;
+                    }
+                    count++;
+                }
+            }
+        }
+
+        if (count > 1)
+        {
+            // Two or more pieces on one cell is a block
+            cell[0] = '#';
+            cell[1] = '0' + count;
+        }
+        else if (count == 0 && position == game->mysteryCell.position)
+        {
+            cell[0] = cell[1] = '?';
+        }
+
+        int row, col;
+        trackCell(position, &row, &col);
+        putCell(renderer, row, col, cell);
+    }
+}
+
+// The engine keeps pieces on the home path at track-range positions, so only
+// pieces that reached home are shown, at the inner end of their lane.
+static void drawHomePaths(BoardRenderer *renderer, GameState *game)
+{
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        char lower = colorLetter(game->players[i].color) - 'A' + 'a';
+        int row, col;
+        trackCell((i * 13 + 2) % BOARD_SIZE, &row, &col);
+
+        for (int step = 1; step <= HOME_PATH_SIZE; step++)
+        {
+            char cell[3] = {lower, '.', '\0'};
+            if (step == HOME_PATH_SIZE && game->players[i].piecesInHome > 0)
+            {
+                cell[0] = colorLetter(game->players[i].color);
+                cell[1] = '0' + game->players[i].piecesInHome;
+            }
+            putCell(renderer, row + step * laneSteps[i][0], col + step * laneSteps[i][1], cell);
+        }
+    }
+}
+
+static void drawPanel(BoardRenderer *renderer, GameState *game)
+{
+    char line[FRAME_COLS + 1];
+    int length;
+
+    length = snprintf(line, sizeof(line), "BASE");
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        length += snprintf(line + length, sizeof(line) - length, " %c%d",
+                           colorLetter(game->players[i].color), game->players[i].piecesInBase);
+    }
+    putCell(renderer, 5, 3, line);
+
+    length = snprintf(line, sizeof(line), "HOME");
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        length += snprintf(line + length, sizeof(line) - length, " %c%d",
+                           colorLetter(game->players[i].color), game->players[i].piecesInHome);
+    }
+    putCell(renderer, 6, 3, line);
+
+    if (game->mysteryCell.position != -1)
+    {
+        snprintf(line, sizeof(line), "MYSTERY %d", game->mysteryCell.position);
+    }
+    else
+    {
+        snprintf(line, sizeof(line), "MYSTERY --");
+    }
+    putCell(renderer, 7, 3, line);
+}
+
+static void composeFrame(BoardRenderer *renderer, GameState *game, const char *status)
+{
+    char line[FRAME_COLS + 1];
+
+    memset(renderer->current, ' ', sizeof(renderer->current));
+
+    snprintf(line, sizeof(line), "Round %-4d %s", game->roundCount, status);
+    putText(renderer, 0, 0, line);
+
+    drawTrack(renderer, game);
+    drawHomePaths(renderer, game);
+    drawPanel(renderer, game);
+
+    putText(renderer, FRAME_ROWS - 1, 0, "Yn piece or home count  #n block  ?? mystery");
+}
+
+// Emits cursor-addressed runs for every cell that differs from the last
+// frame and hands the whole frame to the terminal in a single write.
+static void flushFrame(BoardRenderer *renderer)
+{
+    char buffer[FRAME_ROWS * 160 + 64];
+    size_t length = 0;
+
+    if (renderer->framesDrawn == 0)
+    {
+        length += snprintf(buffer, sizeof(buffer), "\x1b[2J\x1b[?25l");
+    }
+
+    for (int row = 0; row < FRAME_ROWS; row++)
+    {
+        char *current = renderer->current[row];
+        char *previous = renderer->previous[row];
+        int col = 0;
+
+        while (col < FRAME_COLS)
+        {
+            if (current[col] == previous[col])
+            {
+                col++;
+                continue;
+            }
+
+            int start = col;
+            int end = col;
+            for (int next = col + 1; next < FRAME_COLS && next - end <= RUN_MERGE_GAP; next++)
+            {
+                if (current[next] != previous[next])
+                {
+                    end = next;
+                }
+            }
+
+            length += snprintf(buffer + length, sizeof(buffer) - length, "\x1b[%d;%dH", row + 1, start + 1);
+            memcpy(buffer + length, current + start, end - start + 1);
+            length += end - start + 1;
+            col = end + 1;
+        }
+    }
+
+    if (length > 0)
+    {
+        fwrite(buffer, 1, length, renderer->out);
+        fflush(renderer->out);
+    }
+
+    memcpy(renderer->previous, renderer->current, sizeof(renderer->current));
+    renderer->bytesWritten += length;
+    renderer->framesDrawn++;
+}
+
+static void waitForFrameSlot(BoardRenderer *renderer)
+{
+    if (renderer->maxFps <= 0)
+    {
+        return;
+    }
+
+    double remaining = renderer->lastFrameTime + 1.0 / renderer->maxFps - currentTime();
+    if (remaining > 0)
+    {
+        struct timespec pause;
+        pause.tv_sec = (time_t)remaining;
+        pause.tv_nsec = (long)((remaining - pause.tv_sec) * 1e9);
+        nanosleep(&pause, NULL);
+    }
+    renderer->lastFrameTime = currentTime();
+}
+
+void initRenderer(BoardRenderer *renderer, FILE *out, int maxFps, int frameSkip)
+{
+    memset(renderer, 0, sizeof(*renderer));
+    renderer->out = out;
+    renderer->maxFps = maxFps;
+    renderer->frameSkip = frameSkip;
+    renderer->lastFrameTime = currentTime();
+}
+
+void renderFrame(BoardRenderer *renderer, GameState *game, const char *status)
+{
+    renderer->framesRequested++;
+
+    // Fast-forward: skipped frames are simply folded into the next diff
+    if (renderer->pendingSkips > 0)
+    {
+        renderer->pendingSkips--;
+        return;
+    }
+    renderer->pendingSkips = renderer->frameSkip;
+
+    composeFrame(renderer, game, status);
+    waitForFrameSlot(renderer);
+    flushFrame(renderer);
+}
+
+void finishRenderer(BoardRenderer *renderer, GameState *game, const char *status)
+{
+    // The closing frame is always drawn, so it counts as requested too
+    renderer->framesRequested++;
+    composeFrame(renderer, game, status);
+    flushFrame(renderer);
+
+    fprintf(renderer->out, "\x1b[%d;1H\x1b[?25h\n", FRAME_ROWS + 1);
+    fprintf(renderer->out, "Drew %d of %d frames, %ld bytes (%.1f bytes per frame).\n",
+            renderer->framesDrawn, renderer->framesRequested, renderer->bytesWritten,
+            renderer->framesRequested > 0 ? (double)renderer->bytesWritten / renderer->framesRequested : 0.0);
+}
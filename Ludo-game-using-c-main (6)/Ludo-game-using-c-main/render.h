@@ -0,0 +1,32 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "types.h"
+#include <stdio.h>
+
+// Board picture: one status line, the 14x14 track ring and one footer line.
+// Every cell is 2 characters plus a separator.
+#define TRACK_SIDE 14
+#define CELL_WIDTH 3
+#define FRAME_ROWS (TRACK_SIDE + 2)
+#define FRAME_COLS 48
+
+typedef struct
+{
+    FILE *out;
+    char current[FRAME_ROWS][FRAME_COLS];
+    char previous[FRAME_ROWS][FRAME_COLS];
+    int maxFps;          // 0 means no frame rate cap
+    int frameSkip;       // draw one frame out of every frameSkip + 1 requests
+    int pendingSkips;
+    double lastFrameTime;
+    long bytesWritten;
+    int framesDrawn;
+    int framesRequested;
+} BoardRenderer;
+
+void initRenderer(BoardRenderer *renderer, FILE *out, int maxFps, int frameSkip);
+void renderFrame(BoardRenderer *renderer, GameState *game, const char *status);
+void finishRenderer(BoardRenderer *renderer, GameState *game, const char *status);
+
+#endif // RENDER_H
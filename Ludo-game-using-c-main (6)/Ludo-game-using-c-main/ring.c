@@ -0,0 +1,717 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "ring.h"
+#include "runaway.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Empty polls a reader spins through before it starts sleeping
+#define READER_SPINS 256
+#define READER_SLEEP_US 200
+#define WATCH_RETRY_MS 20
+
+// Publish latency is timed over batches, one clock read per batch
+#define BENCH_BATCH 64
+#define BENCH_SAMPLE_EVENTS 4096
+#define MAX_BENCH_READERS 256
+
+typedef char ringEventIsWords[sizeof(GameEvent) == RING_EVENT_WORDS * 8 ? 1 : -1];
+typedef char ringSlotIs32Bytes[sizeof(RingSlot) == 32 ? 1 : -1];
+
+static double currentTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void pauseMicros(long microseconds)
+{
+    struct timespec pause;
+    pause.tv_sec = microseconds / 1000000;
+    pause.tv_nsec = (microseconds % 1000000) * 1000L;
+    nanosleep(&pause, NULL);
+}
+
+// POSIX shared memory names are a single "/name" component
+static bool setRingName(EventRing *ring, const char *name)
+{
+    int written = snprintf(ring->name, sizeof(ring->name), "%s%s", name[0] == '/' ? "" : "/", name);
+    if (written < 0 || written >= (int)sizeof(ring->name) || strchr(ring->name + 1, '/') != NULL)
+    {
+        fprintf(stderr, "Bad ring name %s.\n", name);
+        return false;
+    }
+    return true;
+}
+
+static size_t ringMapSize(uint64_t slotCount)
+{
+    return sizeof(RingHeader) + slotCount * sizeof(RingSlot);
+}
+
+bool createEventRing(EventRing *ring, const char *name, uint64_t slotCount)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+    if (slotCount < 2 || (slotCount & (slotCount - 1)) != 0)
+    {
+        fprintf(stderr, "Ring size must be a power of two.\n");
+        return false;
+    }
+    if (!setRingName(ring, name))
+    {
+        return false;
+    }
+
+    // A ring left behind by a crashed game goes; its readers keep their copy
+    shm_unlink(ring->name);
+    ring->fd = shm_open(ring->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (ring->fd < 0)
+    {
+        perror("Failed to create ring");
+        return false;
+    }
+
+    ring->mapSize = ringMapSize(slotCount);
+    void *map = MAP_FAILED;
+    if (ftruncate(ring->fd, (off_t)ring->mapSize) == 0)
+    {
+        map = mmap(NULL, ring->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+    }
+    if (map == MAP_FAILED)
+    {
+        perror("Failed to map ring");
+        close(ring->fd);
+        shm_unlink(ring->name);
+        return false;
+    }
+
+    ring->owner = true;
+    ring->header = map;
+    ring->slots = (RingSlot *)((unsigned char *)map + sizeof(RingHeader));
+    ring->mask = slotCount - 1;
+    memcpy(ring->header->magic, RING_MAGIC, sizeof(ring->header->magic));
+    ring->header->slotCount = slotCount;
+    __atomic_store_n(&ring->header->slotSize, sizeof(RingSlot), __ATOMIC_RELEASE);
+    return true;
+}
+
+// Fails quietly, with errno ENOENT or EAGAIN, while the ring does not exist
+// yet or is still being set up
+bool openEventRing(EventRing *ring, const char *name)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+    if (!setRingName(ring, name))
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    ring->fd = shm_open(ring->name, O_RDONLY, 0);
+    if (ring->fd < 0)
+    {
+        if (errno != ENOENT)
+        {
+            perror("Failed to open ring");
+        }
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(ring->fd, &info) != 0 || (size_t)info.st_size < sizeof(RingHeader))
+    {
+        close(ring->fd);
+        errno = EAGAIN;
+        return false;
+    }
+
+    ring->mapSize = (size_t)info.st_size;
+    void *map = mmap(NULL, ring->mapSize, PROT_READ, MAP_SHARED, ring->fd, 0);
+    if (map == MAP_FAILED)
+    {
+        int error = errno;
+        perror("Failed to map ring");
+        close(ring->fd);
+        errno = error;
+        return false;
+    }
+    ring->header = map;
+
+    bool ready = __atomic_load_n(&ring->header->slotSize, __ATOMIC_ACQUIRE) == sizeof(RingSlot) &&
+                 memcmp(ring->header->magic, RING_MAGIC, sizeof(ring->header->magic)) == 0;
+    uint64_t slotCount = ring->header->slotCount;
+    if (!ready || slotCount < 2 ||
+        (slotCount & (slotCount - 1)) != 0 || ringMapSize(slotCount) > ring->mapSize)
+    {
+        munmap(map, ring->mapSize);
+        close(ring->fd);
+        errno = EAGAIN;
+        return false;
+    }
+
+    ring->slots = (RingSlot *)((unsigned char *)map + sizeof(RingHeader));
+    ring->mask = slotCount - 1;
+    return true;
+}
+
+// Sequence lock writer: odd version, payload, even version, then the head.
+// Nothing here looks at the readers.
+void publishRingEvent(EventRing *ring, const GameEvent *event)
+{
+    uint64_t sequence = ring->nextSequence++;
+    RingSlot *slot = &ring->slots[sequence & ring->mask];
+    uint64_t words[RING_EVENT_WORDS];
+    memcpy(words, event, sizeof(words));
+
+    __atomic_store_n(&slot->version, 2 * sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (size_t i = 0; i < RING_EVENT_WORDS; i++)
+    {
+        __atomic_store_n(&slot->words[i], words[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&slot->version, 2 * sequence + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->header->head, sequence + 1, __ATOMIC_RELEASE);
+}
+
+void eventRingSink(void *context, const GameEvent *event)
+{
+    publishRingEvent(context, event);
+}
+
+void finishEventRing(EventRing *ring)
+{
+    if (ring->owner && ring->header != NULL)
+    {
+        __atomic_store_n(&ring->header->closed, 1, __ATOMIC_RELEASE);
+    }
+}
+
+void closeEventRing(EventRing *ring)
+{
+    if (ring->header == NULL)
+    {
+        return;
+    }
+    if (ring->owner)
+    {
+        finishEventRing(ring);
+        shm_unlink(ring->name);
+    }
+    munmap(ring->header, ring->mapSize);
+    close(ring->fd);
+    ring->header = NULL;
+    ring->slots = NULL;
+}
+
+void initRingReader(RingReader *reader, const EventRing *ring)
+{
+    uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+    reader->ring = ring;
+    reader->next = head > ring->mask + 1 ? head - (ring->mask + 1) : 0;
+    reader->lost = 0;
+}
+
+RingStatus readRingEvent(RingReader *reader, GameEvent *event, uint64_t *sequence)
+{
+    const EventRing *ring = reader->ring;
+    uint64_t slotCount = ring->mask + 1;
+
+    for (;;)
+    {
+        uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+        if (reader->next == head)
+        {
+            if (!__atomic_load_n(&ring->header->closed, __ATOMIC_ACQUIRE))
+            {
+                return RING_EMPTY;
+            }
+            // The producer closes after its last publish, so one more look settles it
+            if (__atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE) == reader->next)
+            {
+                return RING_CLOSED;
+            }
+            continue;
+        }
+
+        if (head - reader->next > slotCount)
+        {
+            reader->lost += head - slotCount - reader->next;
+            reader->next = head - slotCount;
+        }
+
+        const RingSlot *slot = &ring->slots[reader->next & ring->mask];
+        uint64_t expected = 2 * reader->next + 2;
+        uint64_t words[RING_EVENT_WORDS];
+        uint64_t before = __atomic_load_n(&slot->version, __ATOMIC_ACQUIRE);
+        for (size_t i = 0; i < RING_EVENT_WORDS; i++)
+        {
+            words[i] = __atomic_load_n(&slot->words[i], __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t after = __atomic_load_n(&slot->version, __ATOMIC_RELAXED);
+
+        if (before == expected && after == expected)
+        {
+            memcpy(event, words, sizeof(*event));
+            *sequence = reader->next++;
+            return RING_EVENT;
+        }
+
+        // The producer is already writing this slot's next lap
+        reader->lost++;
+        reader->next++;
+    }
+}
+
+// Spins first, so that a busy ring costs no system calls, then sleeps
+static RingStatus waitRingEvent(RingReader *reader, GameEvent *event, uint64_t *sequence)
+{
+    for (int spins = 0;; spins++)
+    {
+        RingStatus status = readRingEvent(reader, event, sequence);
+        if (status != RING_EMPTY)
+        {
+            return status;
+        }
+        if (spins < READER_SPINS)
+        {
+            sched_yield();
+        }
+        else
+        {
+            pauseMicros(READER_SLEEP_US);
+        }
+    }
+}
+
+bool parseConsumerKind(const char *name, ConsumerKind *kind)
+{
+    if (strcmp(name, "text") == 0)
+    {
+        *kind = CONSUMER_TEXT;
+        return true;
+    }
+    if (strcmp(name, "stats") == 0)
+    {
+        *kind = CONSUMER_STATS;
+        return true;
+    }
+    return false;
+}
+
+typedef struct
+{
+    unsigned long long events;
+    unsigned long long byType[EVENT_TYPE_COUNT];
+    unsigned long long rolls[NUM_PLAYERS][7];
+    unsigned long long captures[NUM_PLAYERS];
+    unsigned long long captured[NUM_PLAYERS];
+    unsigned long long piecesHome[NUM_PLAYERS];
+    int lastRound;
+    bool over;
+    GameEvent gameOver;
+} EventStats;
+
+static void countEvent(EventStats *stats, const GameEvent *event)
+{
+    stats->events++;
+    if (event->type < EVENT_TYPE_COUNT)
+    {
+        stats->byType[event->type]++;
+    }
+    bool seated = event->player >= 0 && event->player < NUM_PLAYERS;
+    if (seated && (event->type == EVENT_ROLL || event->type == EVENT_BONUS_ROLL) && event->value >= 1 &&
+        event->value <= 6)
+    {
+        stats->rolls[event->player][event->value]++;
+    }
+    if (seated && event->type == EVENT_CAPTURE)
+    {
+        stats->captures[event->player]++;
+        if (event->otherPlayer >= 0 && event->otherPlayer < NUM_PLAYERS)
+        {
+            stats->captured[event->otherPlayer]++;
+        }
+    }
+    if (seated && event->type == EVENT_REACHED_HOME)
+    {
+        stats->piecesHome[event->player]++;
+    }
+    if (event->type == EVENT_GAME_OVER)
+    {
+        stats->over = true;
+        stats->gameOver = *event;
+    }
+    stats->lastRound = event->round;
+}
+
+static void printEventStats(const EventStats *stats, unsigned long long lost)
+{
+    printf("Events: %llu read, %llu lost, last round %d\n", stats->events, lost, stats->lastRound);
+    for (int type = 0; type < EVENT_TYPE_COUNT; type++)
+    {
+        if (stats->byType[type] > 0)
+        {
+            printf("  %-16s %llu\n", getEventTypeName((GameEventType)type), stats->byType[type]);
+        }
+    }
+
+    printf("%-7s %7s %7s %9s %9s %5s\n", "seat", "rolls", "sixes", "captures", "captured", "home");
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        unsigned long long rolls = 0;
+        for (int face = 1; face <= 6; face++)
+        {
+            rolls += stats->rolls[i][face];
+        }
+        printf("%-7s %7llu %7llu %9llu %9llu %5llu\n", getColorName((PlayerColor)i), rolls, stats->rolls[i][6],
+               stats->captures[i], stats->captured[i], stats->piecesHome[i]);
+    }
+
+    if (stats->over)
+    {
+        char text[160];
+        formatGameEvent(&stats->gameOver, text, sizeof(text));
+        printf("%s\n", text);
+    }
+}
+
+bool watchEventRing(const char *name, ConsumerKind kind)
+{
+    EventRing ring;
+    bool announced = false;
+    while (!openEventRing(&ring, name))
+    {
+        if (errno != ENOENT && errno != EAGAIN)
+        {
+            return false;
+        }
+        if (!announced)
+        {
+            fprintf(stderr, "Waiting for ring %s...\n", ring.name);
+            announced = true;
+        }
+        pauseMicros(WATCH_RETRY_MS * 1000L);
+    }
+
+    RingReader reader;
+    initRingReader(&reader, &ring);
+    EventStats stats;
+    memset(&stats, 0, sizeof(stats));
+    unsigned long long reportedLost = 0;
+
+    GameEvent event;
+    uint64_t sequence;
+    while (waitRingEvent(&reader, &event, &sequence) == RING_EVENT)
+    {
+        if (kind == CONSUMER_STATS)
+        {
+            countEvent(&stats, &event);
+            continue;
+        }
+
+        if (reader.lost != reportedLost)
+        {
+            printf("[%llu events lost]\n", (unsigned long long)(reader.lost - reportedLost));
+            reportedLost = reader.lost;
+        }
+        char text[160];
+        formatGameEvent(&event, text, sizeof(text));
+        printf("%s\n", text);
+    }
+
+    if (kind == CONSUMER_STATS)
+    {
+        printEventStats(&stats, reader.lost);
+    }
+    else if (reader.lost != reportedLost)
+    {
+        printf("[%llu events lost]\n", (unsigned long long)(reader.lost - reportedLost));
+    }
+    closeEventRing(&ring);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+
+typedef struct
+{
+    unsigned long long events;
+    unsigned long long lost;
+    unsigned long long torn; // events that differ from what was published
+    double seconds;
+} ReaderResult;
+
+typedef struct
+{
+    GameEvent *events;
+    int count;
+} EventSample;
+
+static void sampleSink(void *context, const GameEvent *event)
+{
+    EventSample *sample = context;
+    if (sample->count < BENCH_SAMPLE_EVENTS)
+    {
+        sample->events[sample->count++] = *event;
+    }
+}
+
+// Real events from silent games, so readers verify what they see against them
+static void collectSampleEvents(EventSample *sample)
+{
+    bool logWasEnabled = gameLogEnabled;
+    gameLogEnabled = false;
+    setEventSink(sampleSink, sample);
+
+    for (unsigned long long seed = 1; sample->count < BENCH_SAMPLE_EVENTS; seed++)
+    {
+        GameState game;
+        initializeGame(&game);
+        seedGame(&game, seed);
+        chooseFirstPlayer(&game);
+        for (int turn = 0; turn < DEFAULT_MAX_STALL_TURNS && sample->count < BENCH_SAMPLE_EVENTS; turn++)
+        {
+            playTurn(&game);
+            if (checkForWin(&game, game.currentPlayerIndex))
+            {
+                break;
+            }
+            advanceTurn(&game);
+        }
+    }
+
+    setEventSink(NULL, NULL);
+    gameLogEnabled = logWasEnabled;
+}
+
+static void runBenchReader(const char *name, const EventSample *sample, int readyFd, int resultFd)
+{
+    EventRing ring;
+    ReaderResult result;
+    memset(&result, 0, sizeof(result));
+    if (!openEventRing(&ring, name))
+    {
+        _exit(1);
+    }
+    RingReader reader;
+    initRingReader(&reader, &ring);
+    char ready = 1;
+    if (write(readyFd, &ready, 1) != 1)
+    {
+        _exit(1);
+    }
+
+    GameEvent event;
+    uint64_t sequence;
+    double started = 0;
+    RingStatus status;
+    while ((status = readRingEvent(&reader, &event, &sequence)) != RING_CLOSED)
+    {
+        if (status == RING_EMPTY)
+        {
+            sched_yield();
+            continue;
+        }
+        if (result.events++ == 0)
+        {
+            started = currentTime();
+        }
+        if (memcmp(&event, &sample->events[sequence % sample->count], sizeof(event)) != 0)
+        {
+            result.torn++;
+        }
+    }
+    result.seconds = result.events > 0 ? currentTime() - started : 0;
+    result.lost = reader.lost;
+    closeEventRing(&ring);
+    _exit(write(resultFd, &result, sizeof(result)) == (ssize_t)sizeof(result) ? 0 : 1);
+}
+
+static int compareDoubles(const void *left, const void *right)
+{
+    double a = *(const double *)left;
+    double b = *(const double *)right;
+    return (a > b) - (a < b);
+}
+
+void initRingBenchConfig(RingBenchConfig *config)
+{
+    config->slotCount = DEFAULT_RING_SLOTS;
+    config->events = DEFAULT_RING_BENCH_EVENTS;
+    config->maxReaders = DEFAULT_RING_BENCH_READERS;
+    config->rate = 0;
+}
+
+static bool benchReaders(const char *name, const RingBenchConfig *config, int readers, const EventSample *sample,
+                         double *batchNanos)
+{
+    EventRing ring;
+    if (!createEventRing(&ring, name, config->slotCount))
+    {
+        return false;
+    }
+
+    int readyPipe[2], resultPipe[2];
+    if (pipe(readyPipe) != 0 || pipe(resultPipe) != 0)
+    {
+        perror("Failed to create pipes");
+        closeEventRing(&ring);
+        return false;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t children[MAX_BENCH_READERS];
+    int started = 0;
+    for (; started < readers; started++)
+    {
+        children[started] = fork();
+        if (children[started] == 0)
+        {
+            close(readyPipe[0]);
+            close(resultPipe[0]);
+            runBenchReader(ring.name, sample, readyPipe[1], resultPipe[1]);
+        }
+        if (children[started] < 0)
+        {
+            perror("Failed to start reader");
+            break;
+        }
+    }
+    close(readyPipe[1]);
+    close(resultPipe[1]);
+
+    // Every reader is attached before the first event goes out
+    int attached = 0;
+    char ready;
+    while (attached < started && read(readyPipe[0], &ready, 1) == 1)
+    {
+        attached++;
+    }
+
+    // Only the publishing is timed, not the pauses that keep to the rate
+    uint64_t batches = config->events / BENCH_BATCH;
+    double publishNanos = 0;
+    double wallStarted = currentTime();
+    for (uint64_t batch = 0; batch < batches; batch++)
+    {
+        double batchStarted = currentTime();
+        for (uint64_t sequence = batch * BENCH_BATCH; sequence < (batch + 1) * BENCH_BATCH; sequence++)
+        {
+            publishRingEvent(&ring, &sample->events[sequence % sample->count]);
+        }
+        double now = currentTime();
+        batchNanos[batch] = (now - batchStarted) * 1e9 / BENCH_BATCH;
+        publishNanos += (now - batchStarted) * 1e9;
+
+        while (config->rate > 0 && now - wallStarted < (batch + 1) * BENCH_BATCH / config->rate)
+        {
+            sched_yield();
+            now = currentTime();
+        }
+    }
+    double wallSeconds = currentTime() - wallStarted;
+    closeEventRing(&ring);
+
+    ReaderResult total;
+    memset(&total, 0, sizeof(total));
+    int reported = 0;
+    double readRate = 0;
+    ReaderResult result;
+    while (reported < attached && read(resultPipe[0], &result, sizeof(result)) == (ssize_t)sizeof(result))
+    {
+        total.events += result.events;
+        total.lost += result.lost;
+        total.torn += result.torn;
+        readRate += result.seconds > 0 ? result.events / result.seconds : 0;
+        reported++;
+    }
+    close(readyPipe[0]);
+    close(resultPipe[0]);
+    for (int i = 0; i < started; i++)
+    {
+        waitpid(children[i], NULL, 0);
+    }
+
+    qsort(batchNanos, batches, sizeof(double), compareDoubles);
+    uint64_t published = batches * BENCH_BATCH;
+    printf("%-7d %10.1f %10.1f %10.1f %10.1f %12.2f %12.2f %8.2f%% %6llu%s\n", readers,
+           publishNanos / (published > 0 ? published : 1), batches > 0 ? batchNanos[batches / 2] : 0,
+           batches > 0 ? batchNanos[batches * 99 / 100] : 0, batches > 0 ? batchNanos[batches - 1] : 0,
+           wallSeconds > 0 ? published / wallSeconds / 1e6 : 0,
+           reported > 0 ? readRate / reported / 1e6 : 0,
+           reported > 0 && published > 0 ? 100.0 * total.lost / ((double)published * reported) : 0, total.torn,
+           reported < readers ? "  (readers missing)" : "");
+    return reported == readers;
+}
+
+bool runRingBenchmark(const RingBenchConfig *config)
+{
+    RingBenchConfig run = *config;
+    char name[64];
+    snprintf(name, sizeof(name), "/ludo-ring-bench-%d", (int)getpid());
+
+    if (run.maxReaders > MAX_BENCH_READERS)
+    {
+        run.maxReaders = MAX_BENCH_READERS;
+    }
+    if (run.events < BENCH_BATCH)
+    {
+        run.events = BENCH_BATCH;
+    }
+
+    EventSample sample;
+    sample.events = malloc(BENCH_SAMPLE_EVENTS * sizeof(GameEvent));
+    sample.count = 0;
+    double *batchNanos = malloc((run.events / BENCH_BATCH) * sizeof(double));
+    if (sample.events == NULL || batchNanos == NULL)
+    {
+        perror("Failed to allocate benchmark buffers");
+        free(sample.events);
+        free(batchNanos);
+        return false;
+    }
+    collectSampleEvents(&sample);
+
+    printf("Ring benchmark: %llu events ", (unsigned long long)run.events);
+    if (run.rate > 0)
+    {
+        printf("at %.0f/s, ", run.rate);
+    }
+    else
+    {
+        printf("flat out, ");
+    }
+    printf("%llu slots of %zu bytes, publish latency per event timed over batches of %d\n",
+           (unsigned long long)run.slotCount, sizeof(RingSlot), BENCH_BATCH);
+    printf("%-7s %10s %10s %10s %10s %12s %12s %9s %6s\n", "readers", "mean ns", "p50 ns", "p99 ns", "max ns",
+           "publish M/s", "read M/s", "lost", "torn");
+
+    bool ok = true;
+    for (int readers = 0; readers <= run.maxReaders && ok; readers = readers == 0 ? 1 : readers * 2)
+    {
+        ok = benchReaders(name, &run, readers, &sample, batchNanos);
+        if (readers < run.maxReaders && readers * 2 > run.maxReaders)
+        {
+            ok = ok && benchReaders(name, &run, run.maxReaders, &sample, batchNanos);
+            break;
+        }
+    }
+
+    free(sample.events);
+    free(batchNanos);
+    return ok;
+}
@@ -0,0 +1,101 @@
+#ifndef RING_H
+#define RING_H
+
+#include "events.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RING_MAGIC "LUDORNG1"
+#define DEFAULT_RING_NAME "/ludo-events"
+#define DEFAULT_RING_SLOTS 65536
+#define DEFAULT_RING_BENCH_EVENTS 2000000
+#define DEFAULT_RING_BENCH_READERS 16
+#define RING_EVENT_WORDS (sizeof(GameEvent) / 8)
+
+// A slot is a sequence lock around one event: the version is odd while the
+// producer writes and 2 * (sequence + 1) once event number sequence is in.
+typedef struct
+{
+    uint64_t version;
+    uint64_t words[RING_EVENT_WORDS];
+    uint64_t padding[3 - RING_EVENT_WORDS]; // 32-byte slots never straddle a cache line
+} RingSlot;
+
+// Start of the shared mapping. Readers never write to it, so the producer
+// does not know or wait for them: a slow reader is lapped and told so.
+typedef struct
+{
+    char magic[8];
+    uint64_t slotCount; // power of two
+    uint64_t slotSize;  // stored last: readers wait until it is set
+    uint64_t reserved[5];
+    uint64_t head;      // events published, on a cache line of its own
+    uint64_t closed;    // set once the producer is done
+    uint64_t padding[6];
+} RingHeader;
+
+typedef struct
+{
+    char name[256];
+    bool owner;
+    int fd;
+    size_t mapSize;
+    RingHeader *header;
+    RingSlot *slots;
+    uint64_t mask;
+    uint64_t nextSequence; // owner only
+} EventRing;
+
+typedef struct
+{
+    const EventRing *ring;
+    uint64_t next; // sequence of the next event to read
+    uint64_t lost; // events overwritten before this reader got to them
+} RingReader;
+
+typedef enum
+{
+    RING_EVENT,
+    RING_EMPTY,
+    RING_CLOSED
+} RingStatus;
+
+typedef struct
+{
+    uint64_t slotCount;
+    uint64_t events;   // published per run
+    int maxReaders;
+    double rate;       // events per second, 0 publishes flat out
+} RingBenchConfig;
+
+typedef enum
+{
+    CONSUMER_TEXT,
+    CONSUMER_STATS
+} ConsumerKind;
+
+// name is a POSIX shared memory name such as "/ludo"
+bool createEventRing(EventRing *ring, const char *name, uint64_t slotCount);
+bool openEventRing(EventRing *ring, const char *name);
+void publishRingEvent(EventRing *ring, const GameEvent *event);
+void eventRingSink(void *context, const GameEvent *event); // EventSink publishing to an EventRing
+// Owner only: no more events. Readers drain what is left and stop, and
+// readers that attach later still get what the ring holds.
+void finishEventRing(EventRing *ring);
+// Unmaps the ring; the owner finishes it and removes its name as well
+void closeEventRing(EventRing *ring);
+
+// Starts at the oldest event the ring still holds
+void initRingReader(RingReader *reader, const EventRing *ring);
+RingStatus readRingEvent(RingReader *reader, GameEvent *event, uint64_t *sequence);
+
+bool parseConsumerKind(const char *name, ConsumerKind *kind);
+// Follows a ring until its producer closes it; waits for the ring to appear
+bool watchEventRing(const char *name, ConsumerKind kind);
+
+void initRingBenchConfig(RingBenchConfig *config);
+// Publish latency and reader throughput with no readers, then 1, 2, 4 ...
+// maxReaders forked readers, each checking every event it reads
+bool runRingBenchmark(const RingBenchConfig *config);
+
+#endif // RING_H
@@ -0,0 +1,251 @@
+#include "runaway.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void initRunawayLimits(RunawayLimits *limits)
+{
+    limits->maxTurns = DEFAULT_MAX_TURNS;
+    limits->maxStallTurns = DEFAULT_MAX_STALL_TURNS;
+    limits->cycleWindow = DEFAULT_CYCLE_WINDOW;
+    limits->cycleRepeats = DEFAULT_CYCLE_REPEATS;
+}
+
+const char *getOutcomeName(GameOutcome outcome)
+{
+    switch (outcome)
+    {
+    case OUTCOME_FINISHED:
+        return "finished";
+    case OUTCOME_TURN_CAP:
+        return "turn cap";
+    case OUTCOME_STALLED:
+        return "stalled";
+    case OUTCOME_CYCLE:
+        return "cycle";
+    default:
+        return "unknown";
+    }
+}
+
+static unsigned long long mixKey(unsigned long long x)
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Packs a piece into 16 bits: where it is, plus the flags the rules look at.
+// Captures only matter as "has captured", so the count itself is left out.
+static unsigned long long packPiece(const Piece *piece)
+{
+    // Written without branches: piece states are close to random from turn to
+    // turn, and mispredicted branches here cost more than the rest of the hash
+    unsigned long long onTrack = !piece->isBase & !piece->isHome;
+    unsigned long long place = (onTrack * (unsigned long long)(2 + piece->position * 2 + piece->direction)) |
+                               (!piece->isBase & piece->isHome);
+    unsigned long long flags = (piece->captures > 0) | (piece->isEnergized << 1) | (piece->isSick << 2) |
+                               ((unsigned long long)piece->briefingRoundsLeft << 3);
+    return ((place & 0xFF) << 8) | (flags & 0xFF);
+}
+
+// Odd multipliers that spread each packed word over the whole hash
+static const unsigned long long wordKeys[NUM_PLAYERS + 1] = {
+    0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL, 0xFF51AFD7ED558CCDULL,
+};
+
+// Hash over everything that shapes the rest of the game. The round number and
+// the random generator are left out, as they never repeat. Each player's four
+// pieces share a word; the words are multiplied independently and mixed once,
+// which keeps the hash to a few nanoseconds a turn.
+unsigned long long hashGameState(const GameState *game)
+{
+    unsigned long long hash = (((unsigned long long)(game->mysteryCell.position + 1) << 16) |
+                               ((unsigned long long)game->mysteryCell.roundsLeft << 8) |
+                               (unsigned long long)game->currentPlayerIndex) * wordKeys[NUM_PLAYERS];
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        const Piece *pieces = game->players[i].pieces;
+        unsigned long long word = 0;
+        for (int j = 0; j < PIECES_PER_PLAYER; j++)
+        {
+            word = (word << 16) | packPiece(&pieces[j]);
+        }
+        hash += (word + 1) * wordKeys[i];
+    }
+    return mixKey(hash);
+}
+
+static int windowSamples(const RunawayLimits *limits)
+{
+    return (limits->cycleWindow + NUM_PLAYERS - 1) / NUM_PLAYERS;
+}
+
+static unsigned int tableSize(const RunawayLimits *limits)
+{
+    unsigned int size = 1;
+    while (size < 2 * (unsigned int)windowSamples(limits))
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+size_t runawayStorageSize(const RunawayLimits *limits)
+{
+    if (limits->cycleWindow <= 0)
+    {
+        return 0;
+    }
+    return tableSize(limits) * sizeof(StateCount) + windowSamples(limits) * sizeof(unsigned long long);
+}
+
+void initRunawayDetectorIn(RunawayDetector *detector, const RunawayLimits *limits, void *storage)
+{
+    memset(detector, 0, sizeof(*detector));
+    detector->limits = *limits;
+
+    if (limits->cycleWindow > 0)
+    {
+        detector->windowSamples = windowSamples(limits);
+        detector->tableMask = tableSize(limits) - 1;
+        detector->counts = storage;
+        detector->recent = (unsigned long long *)(detector->counts + detector->tableMask + 1);
+    }
+    resetRunawayDetector(detector);
+}
+
+void initRunawayDetector(RunawayDetector *detector, const RunawayLimits *limits)
+{
+    size_t size = runawayStorageSize(limits);
+    void *storage = NULL;
+    if (size > 0 && (storage = malloc(size)) == NULL)
+    {
+        perror("Failed to allocate cycle detector");
+        exit(1);
+    }
+    initRunawayDetectorIn(detector, limits, storage);
+    detector->ownedStorage = storage;
+}
+
+void resetRunawayDetector(RunawayDetector *detector)
+{
+    detector->turns = 0;
+    detector->lastProgressTurn = 0;
+    detector->piecesHome = 0;
+    detector->samples = 0;
+    if (detector->counts != NULL)
+    {
+        memset(detector->counts, 0, (detector->tableMask + 1) * sizeof(StateCount));
+    }
+}
+
+void freeRunawayDetector(RunawayDetector *detector)
+{
+    free(detector->ownedStorage);
+    detector->ownedStorage = NULL;
+    detector->recent = NULL;
+    detector->counts = NULL;
+}
+
+static unsigned int findSlot(const RunawayDetector *detector, unsigned long long key)
+{
+    unsigned int slot = (unsigned int)key & detector->tableMask;
+    while (detector->counts[slot].count != 0 && detector->counts[slot].key != key)
+    {
+        slot = (slot + 1) & detector->tableMask;
+    }
+    return slot;
+}
+
+static int addState(RunawayDetector *detector, unsigned long long key)
+{
+    StateCount *entry = &detector->counts[findSlot(detector, key)];
+    entry->key = key;
+    return ++entry->count;
+}
+
+// Linear probing with backward-shift deletion, so the table never fills up
+// with tombstones as the window slides
+static void dropState(RunawayDetector *detector, unsigned long long key)
+{
+    unsigned int mask = detector->tableMask;
+    unsigned int hole = findSlot(detector, key);
+
+    if (--detector->counts[hole].count > 0)
+    {
+        return;
+    }
+
+    unsigned int next = hole;
+    for (;;)
+    {
+        next = (next + 1) & mask;
+        if (detector->counts[next].count == 0)
+        {
+            break;
+        }
+        unsigned int home = (unsigned int)detector->counts[next].key & mask;
+        bool staysPut = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!staysPut)
+        {
+            detector->counts[hole] = detector->counts[next];
+            hole = next;
+        }
+    }
+    detector->counts[hole].count = 0;
+}
+
+bool runawayDetected(RunawayDetector *detector, const GameState *game, GameOutcome *outcome)
+{
+    const RunawayLimits *limits = &detector->limits;
+    detector->turns++;
+
+    int piecesHome = 0;
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        piecesHome += game->players[i].piecesInHome;
+    }
+    if (piecesHome > detector->piecesHome)
+    {
+        detector->piecesHome = piecesHome;
+        detector->lastProgressTurn = detector->turns;
+    }
+
+    // One position per round is sampled, the one with the first seat to move,
+    // at a quarter of the cost of hashing every turn. Dice are drawn between
+    // seats, so a position that recurs with another seat to move need not
+    // recur at the first seat: cycles that only show up at other seats are
+    // missed, and the stall and turn limits are left to stop those games.
+    if (detector->counts != NULL && game->currentPlayerIndex == 0)
+    {
+        unsigned long long key = hashGameState(game);
+        int slot = detector->samples % detector->windowSamples;
+        if (++detector->samples > detector->windowSamples)
+        {
+            dropState(detector, detector->recent[slot]);
+        }
+        detector->recent[slot] = key;
+
+        if (addState(detector, key) >= limits->cycleRepeats && limits->cycleRepeats > 0)
+        {
+            *outcome = OUTCOME_CYCLE;
+            return true;
+        }
+    }
+
+    if (limits->maxStallTurns > 0 && detector->turns - detector->lastProgressTurn >= limits->maxStallTurns)
+    {
+        *outcome = OUTCOME_STALLED;
+        return true;
+    }
+
+    if (limits->maxTurns > 0 && detector->turns >= limits->maxTurns)
+    {
+        *outcome = OUTCOME_TURN_CAP;
+        return true;
+    }
+
+    return false;
+}
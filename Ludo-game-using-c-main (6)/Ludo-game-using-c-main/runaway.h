@@ -0,0 +1,71 @@
+#ifndef RUNAWAY_H
+#define RUNAWAY_H
+
+#include "types.h"
+#include <stddef.h>
+
+// Games can go on practically forever: home entry needs a capture and an
+// exact six onto the starting cell, moveBlock skips the home logic and
+// breakBlockade does nothing. These limits stop such games; 0 disables one.
+#define DEFAULT_MAX_TURNS 100000
+#define DEFAULT_MAX_STALL_TURNS 20000
+#define DEFAULT_CYCLE_WINDOW 4096
+#define DEFAULT_CYCLE_REPEATS 32
+
+typedef enum
+{
+    OUTCOME_FINISHED, // somebody won
+    OUTCOME_TURN_CAP, // ran into maxTurns
+    OUTCOME_STALLED,  // no piece reached home for maxStallTurns turns
+    OUTCOME_CYCLE     // one sampled position came back cycleRepeats times within cycleWindow turns
+} GameOutcome;
+
+#define OUTCOME_COUNT 4
+
+typedef struct
+{
+    int maxTurns;
+    int maxStallTurns;
+    int cycleWindow;
+    int cycleRepeats;
+} RunawayLimits;
+
+typedef struct
+{
+    unsigned long long key;
+    int count;
+} StateCount;
+
+typedef struct
+{
+    RunawayLimits limits;
+    int turns;
+    int lastProgressTurn;
+    int piecesHome;
+    int samples;                // positions hashed so far, one per round
+    int windowSamples;          // rounds that fit in cycleWindow turns
+    unsigned long long *recent; // ring buffer of the last windowSamples state hashes
+    StateCount *counts;         // open addressing table over the ring buffer
+    unsigned int tableMask;
+    void *ownedStorage;         // what freeRunawayDetector releases
+} RunawayDetector;
+
+void initRunawayLimits(RunawayLimits *limits);
+const char *getOutcomeName(GameOutcome outcome);
+unsigned long long hashGameState(const GameState *game);
+
+void initRunawayDetector(RunawayDetector *detector, const RunawayLimits *limits);
+
+// For callers that keep detectors in their own memory: storage must hold
+// runawayStorageSize() bytes, aligned for unsigned long long, and outlive
+// the detector
+size_t runawayStorageSize(const RunawayLimits *limits);
+void initRunawayDetectorIn(RunawayDetector *detector, const RunawayLimits *limits, void *storage);
+void resetRunawayDetector(RunawayDetector *detector);
+void freeRunawayDetector(RunawayDetector *detector);
+
+// Call once after every completed turn. Returns true, with the reason in
+// outcome, when the game should be stopped.
+bool runawayDetected(RunawayDetector *detector, const GameState *game, GameOutcome *outcome);
+
+#endif // RUNAWAY_H
@@ -0,0 +1,942 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "shard.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_WORKERS 64
+#define POLL_INTERVAL_MS 100
+#define CONNECT_ATTEMPTS 50
+
+// Socket messages are a type and a payload length followed by the payload
+#define MESSAGE_HEADER_SIZE 8
+#define SHARD_MESSAGE_SIZE (8 * 3 + SIM_CONFIG_SIZE)
+
+enum
+{
+    MSG_READY = 1, // worker -> coordinator, no payload
+    MSG_SHARD,     // coordinator -> worker: shard id, first game, count and the encoded SimConfig
+    MSG_RESULT,    // worker -> coordinator: shard id and an encoded SimResult
+    MSG_DONE       // coordinator -> worker, no payload
+};
+
+typedef enum
+{
+    SHARD_PENDING,
+    SHARD_ASSIGNED,
+    SHARD_DONE
+} ShardState;
+
+typedef struct
+{
+    unsigned long long firstGame;
+    unsigned long long gameCount;
+    ShardState state;
+    int holders; // workers currently running this shard
+    double assignedAt;
+    SimResult result;
+} Shard;
+
+typedef struct
+{
+    int fd;
+    int shard; // -1 while the worker has nothing to do
+    bool ready;
+    unsigned char *buffer;
+    size_t length;
+    size_t capacity;
+} WorkerLink;
+
+static double currentTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void pauseMillis(int milliseconds)
+{
+    struct timespec pause;
+    pause.tv_sec = milliseconds / 1000;
+    pause.tv_nsec = (milliseconds % 1000) * 1000000L;
+    nanosleep(&pause, NULL);
+}
+
+void initStudyConfig(StudyConfig *study)
+{
+    initSimConfig(&study->sim);
+    study->games = 0;
+    study->shardSize = DEFAULT_SHARD_SIZE;
+    study->socketPath = NULL;
+    study->directory = NULL;
+    study->spawnWorkers = 0;
+    study->timeoutSeconds = DEFAULT_SHARD_TIMEOUT;
+}
+
+static Shard *makeShards(const StudyConfig *study, int *shardCount)
+{
+    unsigned long long shardSize = study->shardSize > 0 ? study->shardSize : DEFAULT_SHARD_SIZE;
+    *shardCount = (int)((study->games + shardSize - 1) / shardSize);
+
+    Shard *shards = calloc(*shardCount > 0 ? *shardCount : 1, sizeof(Shard));
+    if (shards == NULL)
+    {
+        perror("Failed to allocate shards");
+        exit(1);
+    }
+
+    for (int i = 0; i < *shardCount; i++)
+    {
+        shards[i].firstGame = i * shardSize;
+        shards[i].gameCount = study->games - shards[i].firstGame < shardSize ? study->games - shards[i].firstGame : shardSize;
+        shards[i].state = SHARD_PENDING;
+    }
+    return shards;
+}
+
+// Pending shards go first. Once none are left, a shard that has been out for
+// longer than the timeout is handed to an idle worker as well: whichever copy
+// finishes first counts, and both produce the same result anyway.
+static int pickShard(const StudyConfig *study, Shard *shards, int shardCount, double now)
+{
+    int stalest = -1;
+
+    for (int i = 0; i < shardCount; i++)
+    {
+        if (shards[i].state == SHARD_PENDING)
+        {
+            return i;
+        }
+        if (shards[i].state == SHARD_ASSIGNED && now - shards[i].assignedAt > study->timeoutSeconds &&
+            (stalest < 0 || shards[i].assignedAt < shards[stalest].assignedAt))
+        {
+            stalest = i;
+        }
+    }
+    return stalest;
+}
+
+static bool resultMatchesShard(const SimResult *result, const Shard *shard, const SimConfig *config)
+{
+    return result->firstGame == shard->firstGame && result->gameCount == shard->gameCount &&
+           result->stats.games == shard->gameCount && sameSimConfig(&result->config, config);
+}
+
+static void spawnWorkers(const StudyConfig *study, pid_t *children, int closeInChild)
+{
+    fflush(stdout);
+    fflush(stderr);
+
+    for (int i = 0; i < study->spawnWorkers; i++)
+    {
+        children[i] = fork();
+        if (children[i] == 0)
+        {
+            if (closeInChild >= 0)
+            {
+                close(closeInChild);
+            }
+            _exit(runWorker(study->socketPath, study->directory) ? 0 : 1);
+        }
+        if (children[i] < 0)
+        {
+            perror("Failed to start worker");
+        }
+    }
+}
+
+static int liveChildren(pid_t *children, int count)
+{
+    int alive = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (children[i] > 0)
+        {
+            if (waitpid(children[i], NULL, WNOHANG) == children[i])
+            {
+                fprintf(stderr, "Worker %d exited.\n", (int)children[i]);
+                children[i] = 0;
+            }
+            else
+            {
+                alive++;
+            }
+        }
+    }
+    return alive;
+}
+
+static void reapChildren(pid_t *children, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (children[i] > 0)
+        {
+            waitpid(children[i], NULL, 0);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Local socket transport
+
+static bool writeFull(int fd, const unsigned char *data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = write(fd, data, length);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return false;
+        }
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+static bool readFull(int fd, unsigned char *data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t count = read(fd, data, length);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        data += count;
+        length -= count;
+    }
+    return true;
+}
+
+static bool sendMessage(int fd, unsigned int type, const unsigned char *payload, size_t length)
+{
+    unsigned char header[MESSAGE_HEADER_SIZE];
+    putU32(putU32(header, type), (unsigned int)length);
+    return writeFull(fd, header, sizeof(header)) && (length == 0 || writeFull(fd, payload, length));
+}
+
+static bool socketAddress(const char *path, struct sockaddr_un *address)
+{
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path))
+    {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return false;
+    }
+    strcpy(address->sun_path, path);
+    return true;
+}
+
+static void dropLink(WorkerLink *link, Shard *shards)
+{
+    if (link->shard >= 0)
+    {
+        Shard *shard = &shards[link->shard];
+        shard->holders--;
+        if (shard->holders == 0 && shard->state != SHARD_DONE)
+        {
+            fprintf(stderr, "Worker lost, shard %d goes back to the queue.\n", link->shard);
+            shard->state = SHARD_PENDING;
+        }
+    }
+    close(link->fd);
+    free(link->buffer);
+    link->fd = -1;
+}
+
+// Pulls whatever the worker has sent and handles every complete message.
+// Returns false once the worker is gone or misbehaves.
+static bool serviceLink(WorkerLink *link, const StudyConfig *study, Shard *shards, int shardCount, int *shardsDone)
+{
+    for (;;)
+    {
+        if (link->length == link->capacity)
+        {
+            size_t capacity = link->capacity > 0 ? link->capacity * 2 : 4096;
+            unsigned char *buffer = realloc(link->buffer, capacity);
+            if (buffer == NULL)
+            {
+                return false;
+            }
+            link->buffer = buffer;
+            link->capacity = capacity;
+        }
+
+        ssize_t count = read(link->fd, link->buffer + link->length, link->capacity - link->length);
+        if (count == 0)
+        {
+            return false;
+        }
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
+            }
+            return false;
+        }
+        link->length += count;
+    }
+
+    while (link->length >= MESSAGE_HEADER_SIZE)
+    {
+        unsigned int type, payloadLength;
+        getU32(getU32(link->buffer, &type), &payloadLength);
+        if (link->length < MESSAGE_HEADER_SIZE + (size_t)payloadLength)
+        {
+            break;
+        }
+        const unsigned char *payload = link->buffer + MESSAGE_HEADER_SIZE;
+
+        if (type == MSG_READY)
+        {
+            link->ready = true;
+        }
+        else if (type == MSG_RESULT && payloadLength >= 8)
+        {
+            unsigned long long shardId;
+            SimResult result;
+            getU64(payload, &shardId);
+
+            if (shardId >= (unsigned long long)shardCount || (int)shardId != link->shard ||
+                !decodeSimResult(payload + 8, payloadLength - 8, &result))
+            {
+                return false;
+            }
+
+            Shard *shard = &shards[shardId];
+            if (!resultMatchesShard(&result, shard, &study->sim))
+            {
+                fprintf(stderr, "Result for shard %d does not match the study.\n", (int)shardId);
+                freeSimResult(&result);
+                return false;
+            }
+
+            if (shard->state == SHARD_DONE)
+            {
+                freeSimResult(&result); // a slower copy of a shard that already came back
+            }
+            else
+            {
+                shard->result = result;
+                shard->state = SHARD_DONE;
+                (*shardsDone)++;
+            }
+            shard->holders--;
+            link->shard = -1;
+            link->ready = true;
+        }
+        else
+        {
+            return false;
+        }
+
+        link->length -= MESSAGE_HEADER_SIZE + payloadLength;
+        memmove(link->buffer, link->buffer + MESSAGE_HEADER_SIZE + payloadLength, link->length);
+    }
+
+    return true;
+}
+
+static bool assignShard(WorkerLink *link, const StudyConfig *study, Shard *shards, int shardIndex, double now)
+{
+    Shard *shard = &shards[shardIndex];
+    unsigned char payload[SHARD_MESSAGE_SIZE];
+    unsigned char *out = payload;
+    out = putU64(out, shardIndex);
+    out = putU64(out, shard->firstGame);
+    out = putU64(out, shard->gameCount);
+    encodeSimConfig(out, &study->sim);
+
+    if (!sendMessage(link->fd, MSG_SHARD, payload, sizeof(payload)))
+    {
+        return false;
+    }
+
+    if (shard->state == SHARD_ASSIGNED)
+    {
+        fprintf(stderr, "Shard %d is overdue, handing it to another worker.\n", shardIndex);
+    }
+    shard->state = SHARD_ASSIGNED;
+    shard->holders++;
+    shard->assignedAt = now;
+    link->shard = shardIndex;
+    link->ready = false;
+    return true;
+}
+
+static bool coordinateOverSocket(const StudyConfig *study, Shard *shards, int shardCount)
+{
+    struct sockaddr_un address;
+    if (!socketAddress(study->socketPath, &address))
+    {
+        return false;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        perror("socket");
+        return false;
+    }
+    unlink(study->socketPath);
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, MAX_WORKERS) != 0)
+    {
+        perror(study->socketPath);
+        close(listener);
+        return false;
+    }
+    fcntl(listener, F_SETFL, O_NONBLOCK);
+
+    pid_t children[MAX_WORKERS] = {0};
+    int spawned = study->spawnWorkers < MAX_WORKERS ? study->spawnWorkers : MAX_WORKERS;
+    StudyConfig local = *study;
+    local.spawnWorkers = spawned;
+    spawnWorkers(&local, children, listener);
+
+    WorkerLink links[MAX_WORKERS];
+    int linkCount = 0;
+    int shardsDone = 0;
+    bool failed = false;
+
+    while (shardsDone < shardCount)
+    {
+        struct pollfd fds[MAX_WORKERS + 1];
+        fds[0].fd = listener;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < linkCount; i++)
+        {
+            fds[i + 1].fd = links[i].fd;
+            fds[i + 1].events = POLLIN;
+        }
+
+        if (poll(fds, linkCount + 1, POLL_INTERVAL_MS) < 0 && errno != EINTR)
+        {
+            perror("poll");
+            failed = true;
+            break;
+        }
+
+        int polledLinks = linkCount;
+        for (int i = 0; i < polledLinks; i++)
+        {
+            if (fds[i + 1].revents != 0 && !serviceLink(&links[i], study, shards, shardCount, &shardsDone))
+            {
+                dropLink(&links[i], shards);
+            }
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            int fd;
+            while ((fd = accept(listener, NULL, NULL)) >= 0)
+            {
+                if (linkCount == MAX_WORKERS)
+                {
+                    close(fd);
+                    continue;
+                }
+                fcntl(fd, F_SETFL, O_NONBLOCK);
+                memset(&links[linkCount], 0, sizeof(WorkerLink));
+                links[linkCount].fd = fd;
+                links[linkCount].shard = -1;
+                linkCount++;
+            }
+        }
+
+        // Compact away dropped links
+        int kept = 0;
+        for (int i = 0; i < linkCount; i++)
+        {
+            if (links[i].fd >= 0)
+            {
+                links[kept++] = links[i];
+            }
+        }
+        linkCount = kept;
+
+        double now = currentTime();
+        for (int i = 0; i < linkCount && shardsDone < shardCount; i++)
+        {
+            if (!links[i].ready || links[i].shard >= 0)
+            {
+                continue;
+            }
+            int shardIndex = pickShard(study, shards, shardCount, now);
+            if (shardIndex < 0)
+            {
+                break;
+            }
+            if (!assignShard(&links[i], study, shards, shardIndex, now))
+            {
+                links[i].ready = false; // the next poll reports the hang-up
+            }
+        }
+
+        if (spawned > 0 && linkCount == 0 && liveChildren(children, spawned) == 0)
+        {
+            fprintf(stderr, "All workers exited with %d of %d shards outstanding.\n", shardCount - shardsDone, shardCount);
+            failed = true;
+            break;
+        }
+    }
+
+    for (int i = 0; i < linkCount; i++)
+    {
+        sendMessage(links[i].fd, MSG_DONE, NULL, 0);
+        close(links[i].fd);
+        free(links[i].buffer);
+    }
+    close(listener);
+    unlink(study->socketPath);
+
+    if (failed)
+    {
+        for (int i = 0; i < spawned; i++)
+        {
+            if (children[i] > 0)
+            {
+                kill(children[i], SIGTERM);
+            }
+        }
+    }
+    reapChildren(children, spawned);
+    return !failed;
+}
+
+static bool workOverSocket(const char *socketPath)
+{
+    struct sockaddr_un address;
+    if (!socketAddress(socketPath, &address))
+    {
+        return false;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    int fd = -1;
+    for (int attempt = 0; attempt < CONNECT_ATTEMPTS && fd < 0; attempt++)
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+        {
+            close(fd);
+            fd = -1;
+            pauseMillis(POLL_INTERVAL_MS);
+        }
+    }
+    if (fd < 0)
+    {
+        perror(socketPath);
+        return false;
+    }
+
+    bool finished = false;
+    if (sendMessage(fd, MSG_READY, NULL, 0))
+    {
+        for (;;)
+        {
+            unsigned char header[MESSAGE_HEADER_SIZE];
+            unsigned char payload[SHARD_MESSAGE_SIZE];
+            unsigned int type, payloadLength;
+
+            if (!readFull(fd, header, sizeof(header)))
+            {
+                break;
+            }
+            getU32(getU32(header, &type), &payloadLength);
+            if (type == MSG_DONE)
+            {
+                finished = true;
+                break;
+            }
+            if (type != MSG_SHARD || payloadLength != SHARD_MESSAGE_SIZE || !readFull(fd, payload, sizeof(payload)))
+            {
+                break;
+            }
+
+            unsigned long long shardId, firstGame, gameCount;
+            SimConfig config;
+            const unsigned char *in = payload;
+            in = getU64(in, &shardId);
+            in = getU64(in, &firstGame);
+            in = getU64(in, &gameCount);
+            decodeSimConfig(in, &config);
+            if (!applySeatStrategies(&config))
+            {
+                break; // the coordinator hands the shard to another worker
+            }
+
+            SimResult result;
+            runSimulation(&config, firstGame, gameCount, &result);
+
+            unsigned char *blob;
+            size_t blobLength = encodeSimResult(&result, &blob);
+            freeSimResult(&result);
+
+            unsigned char *message = malloc(8 + blobLength);
+            if (message == NULL)
+            {
+                free(blob);
+                break;
+            }
+            putU64(message, shardId);
+            memcpy(message + 8, blob, blobLength);
+            free(blob);
+
+            bool sent = sendMessage(fd, MSG_RESULT, message, 8 + blobLength);
+            free(message);
+            if (!sent)
+            {
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    return finished;
+}
+
+// ---------------------------------------------------------------------------
+// Shared directory transport
+//
+//   study               seed, runaway limits and records flag of the current
+//                       study, then one line per seat with its strategy
+//   shard-N.todo        first game and game count, waiting for a worker
+//   shard-N.claimed     the same file after a worker renamed it to claim it
+//   shard-N.result      encoded SimResult, renamed into place when complete
+//   done                tells workers to exit
+
+static void directoryPath(char *path, size_t size, const char *directory, const char *name)
+{
+    snprintf(path, size, "%s/%s", directory, name);
+}
+
+static void shardPath(char *path, size_t size, const char *directory, int shardIndex, const char *suffix)
+{
+    snprintf(path, size, "%s/shard-%06d.%s", directory, shardIndex, suffix);
+}
+
+static bool fileExists(const char *path)
+{
+    return access(path, F_OK) == 0;
+}
+
+// Writes next to the destination and renames, so readers never see half a file
+static bool writeTextFile(const char *path, const char *text)
+{
+    char temporary[4096];
+    snprintf(temporary, sizeof(temporary), "%s.tmp.%d", path, (int)getpid());
+
+    FILE *file = fopen(temporary, "w");
+    if (file == NULL)
+    {
+        perror(temporary);
+        return false;
+    }
+    fputs(text, file);
+    if (fclose(file) != 0 || rename(temporary, path) != 0)
+    {
+        perror(path);
+        unlink(temporary);
+        return false;
+    }
+    return true;
+}
+
+static void removeShardFiles(const char *directory, bool includeResults)
+{
+    DIR *dir = opendir(directory);
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (strncmp(entry->d_name, "shard-", 6) != 0 ||
+            (!includeResults && strstr(entry->d_name, ".result") != NULL && strstr(entry->d_name, ".tmp.") == NULL))
+        {
+            continue;
+        }
+        char path[4096];
+        directoryPath(path, sizeof(path), directory, entry->d_name);
+        unlink(path);
+    }
+    closedir(dir);
+}
+
+static bool writeShardTodo(const char *directory, Shard *shards, int shardIndex)
+{
+    char path[4096];
+    char text[64];
+    shardPath(path, sizeof(path), directory, shardIndex, "todo");
+    snprintf(text, sizeof(text), "%llu %llu\n", shards[shardIndex].firstGame, shards[shardIndex].gameCount);
+    return writeTextFile(path, text);
+}
+
+static bool coordinateOverDirectory(const StudyConfig *study, Shard *shards, int shardCount)
+{
+    const char *directory = study->directory;
+    char path[4096];
+    char text[128 + NUM_PLAYERS * STRATEGY_SPEC_SIZE];
+
+    if (mkdir(directory, 0777) != 0 && errno != EEXIST)
+    {
+        perror(directory);
+        return false;
+    }
+    directoryPath(path, sizeof(path), directory, "done");
+    unlink(path);
+    removeShardFiles(directory, true);
+
+    directoryPath(path, sizeof(path), directory, "study");
+    const RunawayLimits *limits = &study->sim.limits;
+    int length = snprintf(text, sizeof(text), "%llu %d %d %d %d %d\n", study->sim.studySeed, limits->maxTurns,
+                          limits->maxStallTurns, limits->cycleWindow, limits->cycleRepeats, study->sim.keepRecords ? 1 : 0);
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        length += snprintf(text + length, sizeof(text) - length, "%s\n", study->sim.strategies[i]);
+    }
+    if (!writeTextFile(path, text))
+    {
+        return false;
+    }
+    for (int i = 0; i < shardCount; i++)
+    {
+        if (!writeShardTodo(directory, shards, i))
+        {
+            return false;
+        }
+    }
+
+    pid_t children[MAX_WORKERS] = {0};
+    int spawned = study->spawnWorkers < MAX_WORKERS ? study->spawnWorkers : MAX_WORKERS;
+    StudyConfig local = *study;
+    local.spawnWorkers = spawned;
+    spawnWorkers(&local, children, -1);
+
+    int shardsDone = 0;
+    bool failed = false;
+
+    while (shardsDone < shardCount)
+    {
+        double now = currentTime();
+
+        for (int i = 0; i < shardCount; i++)
+        {
+            Shard *shard = &shards[i];
+            if (shard->state == SHARD_DONE)
+            {
+                continue;
+            }
+
+            shardPath(path, sizeof(path), directory, i, "result");
+            if (fileExists(path))
+            {
+                if (readSimResult(path, &shard->result) && resultMatchesShard(&shard->result, shard, &study->sim))
+                {
+                    shard->state = SHARD_DONE;
+                    shardsDone++;
+                    continue;
+                }
+                fprintf(stderr, "Discarding bad result for shard %d.\n", i);
+                freeSimResult(&shard->result);
+                unlink(path);
+            }
+
+            // A shard counts as taken from the moment its todo file disappears
+            shardPath(path, sizeof(path), directory, i, "todo");
+            if (fileExists(path))
+            {
+                shard->state = SHARD_PENDING;
+            }
+            else if (shard->state == SHARD_PENDING)
+            {
+                shard->state = SHARD_ASSIGNED;
+                shard->assignedAt = now;
+            }
+            else if (now - shard->assignedAt > study->timeoutSeconds)
+            {
+                fprintf(stderr, "Shard %d is overdue, handing it to another worker.\n", i);
+                writeShardTodo(directory, shards, i);
+                shard->state = SHARD_PENDING;
+            }
+        }
+
+        if (shardsDone == shardCount)
+        {
+            break;
+        }
+        if (spawned > 0 && liveChildren(children, spawned) == 0)
+        {
+            fprintf(stderr, "All workers exited with %d of %d shards outstanding.\n", shardCount - shardsDone, shardCount);
+            failed = true;
+            break;
+        }
+        pauseMillis(POLL_INTERVAL_MS);
+    }
+
+    directoryPath(path, sizeof(path), directory, "done");
+    writeTextFile(path, "done\n");
+    removeShardFiles(directory, false);
+    reapChildren(children, spawned);
+    return !failed;
+}
+
+static bool claimShard(const char *directory, int *shardIndex, unsigned long long *firstGame, unsigned long long *gameCount)
+{
+    DIR *dir = opendir(directory);
+    if (dir == NULL)
+    {
+        return false;
+    }
+
+    bool claimed = false;
+    struct dirent *entry;
+    while (!claimed && (entry = readdir(dir)) != NULL)
+    {
+        int index, length = 0;
+        if (sscanf(entry->d_name, "shard-%d.todo%n", &index, &length) != 1 || entry->d_name[length] != '\0' || length == 0)
+        {
+            continue;
+        }
+
+        char todo[4096], claim[4096];
+        shardPath(todo, sizeof(todo), directory, index, "todo");
+        shardPath(claim, sizeof(claim), directory, index, "claimed");
+        if (rename(todo, claim) != 0)
+        {
+            continue; // another worker got there first
+        }
+
+        FILE *file = fopen(claim, "r");
+        if (file != NULL)
+        {
+            claimed = fscanf(file, "%llu %llu", firstGame, gameCount) == 2;
+            fclose(file);
+        }
+        *shardIndex = index;
+    }
+    closedir(dir);
+    return claimed;
+}
+
+static bool workOverDirectory(const char *directory)
+{
+    char path[4096];
+
+    for (;;)
+    {
+        directoryPath(path, sizeof(path), directory, "done");
+        if (fileExists(path))
+        {
+            return true;
+        }
+
+        SimConfig config;
+        int keepRecords = 0;
+        bool haveStudy = false;
+        directoryPath(path, sizeof(path), directory, "study");
+        FILE *file = fopen(path, "r");
+        if (file != NULL)
+        {
+            haveStudy = fscanf(file, "%llu %d %d %d %d %d", &config.studySeed, &config.limits.maxTurns,
+                               &config.limits.maxStallTurns, &config.limits.cycleWindow, &config.limits.cycleRepeats,
+                               &keepRecords) == 6;
+            config.keepRecords = keepRecords != 0;
+            fgetc(file); // end of the first line
+            for (int i = 0; haveStudy && i < NUM_PLAYERS; i++)
+            {
+                haveStudy = fgets(config.strategies[i], STRATEGY_SPEC_SIZE, file) != NULL;
+                config.strategies[i][strcspn(config.strategies[i], "\n")] = '\0';
+            }
+            fclose(file);
+        }
+        if (haveStudy && !applySeatStrategies(&config))
+        {
+            return false; // leaves the shards to workers that can play them
+        }
+
+        int shardIndex;
+        unsigned long long firstGame, gameCount;
+        if (!haveStudy || !claimShard(directory, &shardIndex, &firstGame, &gameCount))
+        {
+            pauseMillis(POLL_INTERVAL_MS);
+            continue;
+        }
+
+        SimResult result;
+        runSimulation(&config, firstGame, gameCount, &result);
+
+        char temporary[4096];
+        snprintf(temporary, sizeof(temporary), "%s/shard-%06d.result.tmp.%d", directory, shardIndex, (int)getpid());
+        shardPath(path, sizeof(path), directory, shardIndex, "result");
+        if (!writeSimResult(temporary, &result) || rename(temporary, path) != 0)
+        {
+            unlink(temporary);
+        }
+        freeSimResult(&result);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+bool runCoordinator(const StudyConfig *study, SimResult *result)
+{
+    int shardCount;
+    Shard *shards = makeShards(study, &shardCount);
+
+    bool completed = study->socketPath != NULL ? coordinateOverSocket(study, shards, shardCount)
+                                               : coordinateOverDirectory(study, shards, shardCount);
+
+    // Merging in shard order keeps the output independent of which worker
+    // finished what, and when
+    memset(result, 0, sizeof(*result));
+    result->config = study->sim;
+    for (int i = 0; i < shardCount; i++)
+    {
+        if (completed && !mergeSimResults(result, &shards[i].result))
+        {
+            completed = false;
+        }
+        freeSimResult(&shards[i].result);
+    }
+    free(shards);
+    return completed;
+}
+
+bool runWorker(const char *socketPath, const char *directory)
+{
+    return socketPath != NULL ? workOverSocket(socketPath) : workOverDirectory(directory);
+}
@@ -0,0 +1,27 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "sim.h"
+
+#define DEFAULT_SHARD_SIZE 1000
+#define DEFAULT_SHARD_TIMEOUT 60.0
+
+// A study is split into shards of consecutive game indices. Workers reach the
+// coordinator either through a local socket or through a shared directory;
+// exactly one of socketPath and directory is set.
+typedef struct
+{
+    SimConfig sim;
+    unsigned long long games;
+    unsigned long long shardSize;
+    const char *socketPath;
+    const char *directory;
+    int spawnWorkers;      // local worker processes started by the coordinator
+    double timeoutSeconds; // shards held longer than this are handed out again
+} StudyConfig;
+
+void initStudyConfig(StudyConfig *study);
+bool runCoordinator(const StudyConfig *study, SimResult *result);
+bool runWorker(const char *socketPath, const char *directory);
+
+#endif // SHARD_H
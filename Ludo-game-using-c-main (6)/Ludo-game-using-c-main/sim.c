@@ -0,0 +1,582 @@
+#include "sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESULT_MAGIC "LUDOSIM3"
+#define RESULT_HEADER_SIZE (8 + SIM_CONFIG_SIZE + 8 * 20)
+#define RESULT_RECORD_SIZE 18
+
+void initSimConfig(SimConfig *config)
+{
+    config->studySeed = 1;
+    initRunawayLimits(&config->limits);
+    config->keepRecords = false;
+    recordSeatStrategies(config);
+}
+
+void recordSeatStrategies(SimConfig *config)
+{
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        strcpy(config->strategies[i], getSeatStrategySpec(i));
+    }
+}
+
+bool applySeatStrategies(const SimConfig *config)
+{
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        if (!setSeatStrategy(i, config->strategies[i]))
+        {
+            fprintf(stderr, "Cannot play the study's %s strategy %s.\n", getColorName(i), config->strategies[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Game seeds only depend on the study seed and the game index, which is what
+// makes a study independent of how it is split up
+static unsigned long long gameSeed(const SimConfig *config, unsigned long long gameIndex)
+{
+    return config->studySeed * 0xD1B54A32D192ED03ULL + gameIndex;
+}
+
+void startSimulatedGame(const SimConfig *config, RunawayDetector *detector, unsigned long long gameIndex,
+                        GameState *game, GameRecord *record)
+{
+    initializeGame(game);
+    seedGame(game, gameSeed(config, gameIndex));
+    chooseFirstPlayer(game);
+    resetRunawayDetector(detector);
+
+    record->gameIndex = gameIndex;
+    record->winner = NO_WINNER;
+    record->outcome = OUTCOME_FINISHED;
+    record->turns = 0;
+    record->rounds = game->roundCount;
+}
+
+bool stepSimulatedGame(GameState *game, RunawayDetector *detector, GameRecord *record)
+{
+    playTurn(game);
+    record->turns++;
+
+    bool over = false;
+    if (checkForWin(game, game->currentPlayerIndex))
+    {
+        record->winner = game->currentPlayerIndex;
+        over = true;
+    }
+    else
+    {
+        advanceTurn(game);
+        over = runawayDetected(detector, game, &record->outcome);
+    }
+    record->rounds = game->roundCount;
+    return over;
+}
+
+void countCaptures(const GameState *game, int captures[NUM_PLAYERS])
+{
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        captures[i] = 0;
+        for (int j = 0; j < PIECES_PER_PLAYER; j++)
+        {
+            captures[i] += game->players[i].pieces[j].captures;
+        }
+    }
+}
+
+void playSimulatedGame(const SimConfig *config, RunawayDetector *detector, unsigned long long gameIndex,
+                       GameRecord *record, int captures[NUM_PLAYERS])
+{
+    GameState game;
+    startSimulatedGame(config, detector, gameIndex, &game, record);
+    while (!stepSimulatedGame(&game, detector, record))
+    {
+    }
+    countCaptures(&game, captures);
+}
+
+void addGameToStats(SimStats *stats, const GameRecord *record, const int captures[NUM_PLAYERS])
+{
+    unsigned long long turns = record->turns;
+
+    if (stats->games == 0 || turns < stats->minTurns)
+    {
+        stats->minTurns = turns;
+    }
+    if (turns > stats->maxTurns)
+    {
+        stats->maxTurns = turns;
+    }
+
+    stats->games++;
+    stats->outcomes[record->outcome]++;
+    if (record->winner != NO_WINNER)
+    {
+        stats->wins[record->winner]++;
+    }
+    stats->totalTurns += turns;
+    stats->totalTurnsSquared += turns * turns;
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        stats->captures[i] += captures[i];
+    }
+}
+
+void runSimulation(const SimConfig *config, unsigned long long firstGame, unsigned long long gameCount, SimResult *result)
+{
+    memset(result, 0, sizeof(*result));
+    result->config = *config;
+    result->firstGame = firstGame;
+    result->gameCount = gameCount;
+
+    if (config->keepRecords && gameCount > 0)
+    {
+        result->records = malloc(gameCount * sizeof(GameRecord));
+        if (result->records == NULL)
+        {
+            perror("Failed to allocate game records");
+            exit(1);
+        }
+    }
+
+    RunawayDetector detector;
+    initRunawayDetector(&detector, &config->limits);
+    bool logWasEnabled = gameLogEnabled;
+    gameLogEnabled = false;
+
+    for (unsigned long long i = 0; i < gameCount; i++)
+    {
+        GameRecord record;
+        int captures[NUM_PLAYERS];
+        playSimulatedGame(config, &detector, firstGame + i, &record, captures);
+        addGameToStats(&result->stats, &record, captures);
+
+        if (result->records != NULL)
+        {
+            result->records[result->recordCount++] = record;
+        }
+    }
+
+    gameLogEnabled = logWasEnabled;
+    freeRunawayDetector(&detector);
+}
+
+// Folds one result into another. Both must belong to the same study, and
+// from must carry on where into stops, so that every game is counted once
+// and the merged range has no holes.
+bool mergeSimResults(SimResult *into, const SimResult *from)
+{
+    if (into->gameCount == 0)
+    {
+        into->config = from->config;
+        into->firstGame = from->firstGame;
+    }
+    else if (!sameSimConfig(&into->config, &from->config))
+    {
+        fprintf(stderr, "Cannot merge results of different studies.\n");
+        return false;
+    }
+
+    if (from->gameCount == 0)
+    {
+        return true;
+    }
+
+    unsigned long long lastGame = from->firstGame + from->gameCount - 1;
+    if (from->firstGame != into->firstGame + into->gameCount)
+    {
+        fprintf(stderr, "Cannot merge games %llu-%llu after games %llu-%llu: the ranges %s.\n", from->firstGame,
+                lastGame, into->firstGame, into->firstGame + into->gameCount - 1,
+                from->firstGame < into->firstGame + into->gameCount ? "overlap" : "leave a gap");
+        return false;
+    }
+    if (from->recordCount != (from->config.keepRecords ? from->gameCount : 0))
+    {
+        fprintf(stderr, "Games %llu-%llu come with %llu records.\n", from->firstGame, lastGame, from->recordCount);
+        return false;
+    }
+
+    mergeSimStats(&into->stats, &from->stats);
+    into->gameCount += from->gameCount;
+
+    // Ranges come in order, so appending keeps the records sorted
+    if (from->recordCount > 0)
+    {
+        GameRecord *records = realloc(into->records, (into->recordCount + from->recordCount) * sizeof(GameRecord));
+        if (records == NULL)
+        {
+            perror("Failed to allocate game records");
+            return false;
+        }
+        memcpy(records + into->recordCount, from->records, from->recordCount * sizeof(GameRecord));
+        into->records = records;
+        into->recordCount += from->recordCount;
+    }
+
+    return true;
+}
+
+void mergeSimStats(SimStats *stats, const SimStats *other)
+{
+    if (other->games == 0)
+    {
+        return;
+    }
+    if (stats->games == 0 || other->minTurns < stats->minTurns)
+    {
+        stats->minTurns = other->minTurns;
+    }
+    if (other->maxTurns > stats->maxTurns)
+    {
+        stats->maxTurns = other->maxTurns;
+    }
+    stats->games += other->games;
+    stats->totalTurns += other->totalTurns;
+    stats->totalTurnsSquared += other->totalTurnsSquared;
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        stats->wins[i] += other->wins[i];
+        stats->captures[i] += other->captures[i];
+    }
+    for (int i = 0; i < OUTCOME_COUNT; i++)
+    {
+        stats->outcomes[i] += other->outcomes[i];
+    }
+}
+
+void freeSimResult(SimResult *result)
+{
+    free(result->records);
+    result->records = NULL;
+    result->recordCount = 0;
+}
+
+// Result blobs are little-endian regardless of the host so that workers on
+// different machines produce byte-identical files
+unsigned char *putU64(unsigned char *out, unsigned long long value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+    return out + 8;
+}
+
+unsigned char *putU32(unsigned char *out, unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+    return out + 4;
+}
+
+const unsigned char *getU64(const unsigned char *in, unsigned long long *value)
+{
+    *value = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        *value |= (unsigned long long)in[i] << (8 * i);
+    }
+    return in + 8;
+}
+
+const unsigned char *getU32(const unsigned char *in, unsigned int *value)
+{
+    *value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        *value |= (unsigned int)in[i] << (8 * i);
+    }
+    return in + 4;
+}
+
+unsigned char *encodeSimConfig(unsigned char *out, const SimConfig *config)
+{
+    out = putU64(out, config->studySeed);
+    out = putU64(out, (unsigned int)config->limits.maxTurns);
+    out = putU64(out, (unsigned int)config->limits.maxStallTurns);
+    out = putU64(out, (unsigned int)config->limits.cycleWindow);
+    out = putU64(out, (unsigned int)config->limits.cycleRepeats);
+    out = putU64(out, config->keepRecords);
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        // Zero padded, so equal configs always encode to equal bytes
+        size_t length = strlen(config->strategies[i]);
+        memcpy(out, config->strategies[i], length);
+        memset(out + length, 0, STRATEGY_SPEC_SIZE - length);
+        out += STRATEGY_SPEC_SIZE;
+    }
+    return out;
+}
+
+const unsigned char *decodeSimConfig(const unsigned char *in, SimConfig *config)
+{
+    unsigned long long value;
+    in = getU64(in, &config->studySeed);
+    in = getU64(in, &value);
+    config->limits.maxTurns = (int)value;
+    in = getU64(in, &value);
+    config->limits.maxStallTurns = (int)value;
+    in = getU64(in, &value);
+    config->limits.cycleWindow = (int)value;
+    in = getU64(in, &value);
+    config->limits.cycleRepeats = (int)value;
+    in = getU64(in, &value);
+    config->keepRecords = value != 0;
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        memcpy(config->strategies[i], in, STRATEGY_SPEC_SIZE);
+        config->strategies[i][STRATEGY_SPEC_SIZE - 1] = '\0';
+        in += STRATEGY_SPEC_SIZE;
+    }
+    return in;
+}
+
+bool sameSimConfig(const SimConfig *left, const SimConfig *right)
+{
+    bool same = left->studySeed == right->studySeed && left->keepRecords == right->keepRecords &&
+           left->limits.maxTurns == right->limits.maxTurns && left->limits.maxStallTurns == right->limits.maxStallTurns &&
+           left->limits.cycleWindow == right->limits.cycleWindow &&
+           left->limits.cycleRepeats == right->limits.cycleRepeats;
+    if (!same)
+    {
+        return false;
+    }
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        if (strcmp(left->strategies[i], right->strategies[i]) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t encodeSimResult(const SimResult *result, unsigned char **buffer)
+{
+    size_t length = RESULT_HEADER_SIZE + result->recordCount * RESULT_RECORD_SIZE;
+    unsigned char *out = malloc(length);
+    if (out == NULL)
+    {
+        perror("Failed to allocate result buffer");
+        exit(1);
+    }
+    *buffer = out;
+
+    const SimStats *stats = &result->stats;
+    memcpy(out, RESULT_MAGIC, 8);
+    out += 8;
+    out = encodeSimConfig(out, &result->config);
+    out = putU64(out, result->firstGame);
+    out = putU64(out, result->gameCount);
+    out = putU64(out, stats->games);
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        out = putU64(out, stats->wins[i]);
+    }
+    for (int i = 0; i < OUTCOME_COUNT; i++)
+    {
+        out = putU64(out, stats->outcomes[i]);
+    }
+    out = putU64(out, stats->totalTurns);
+    out = putU64(out, stats->totalTurnsSquared);
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        out = putU64(out, stats->captures[i]);
+    }
+    out = putU64(out, stats->minTurns);
+    out = putU64(out, stats->maxTurns);
+    out = putU64(out, result->recordCount);
+
+    for (unsigned long long i = 0; i < result->recordCount; i++)
+    {
+        const GameRecord *record = &result->records[i];
+        out = putU64(out, record->gameIndex);
+        *out++ = (unsigned char)record->winner;
+        *out++ = (unsigned char)record->outcome;
+        out = putU32(out, record->turns);
+        out = putU32(out, record->rounds);
+    }
+
+    return length;
+}
+
+bool decodeSimResult(const unsigned char *buffer, size_t length, SimResult *result)
+{
+    memset(result, 0, sizeof(*result));
+
+    if (length < RESULT_HEADER_SIZE || memcmp(buffer, RESULT_MAGIC, 8) != 0)
+    {
+        fprintf(stderr, "Not a simulation result.\n");
+        return false;
+    }
+
+    SimStats *stats = &result->stats;
+    const unsigned char *in = buffer + 8;
+    in = decodeSimConfig(in, &result->config);
+    in = getU64(in, &result->firstGame);
+    in = getU64(in, &result->gameCount);
+    in = getU64(in, &stats->games);
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        in = getU64(in, &stats->wins[i]);
+    }
+    for (int i = 0; i < OUTCOME_COUNT; i++)
+    {
+        in = getU64(in, &stats->outcomes[i]);
+    }
+    in = getU64(in, &stats->totalTurns);
+    in = getU64(in, &stats->totalTurnsSquared);
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        in = getU64(in, &stats->captures[i]);
+    }
+    in = getU64(in, &stats->minTurns);
+    in = getU64(in, &stats->maxTurns);
+    in = getU64(in, &result->recordCount);
+
+    if (result->recordCount > (length - RESULT_HEADER_SIZE) / RESULT_RECORD_SIZE ||
+        length != RESULT_HEADER_SIZE + result->recordCount * RESULT_RECORD_SIZE)
+    {
+        fprintf(stderr, "Truncated simulation result.\n");
+        result->recordCount = 0;
+        return false;
+    }
+
+    if (result->recordCount > 0)
+    {
+        result->records = malloc(result->recordCount * sizeof(GameRecord));
+        if (result->records == NULL)
+        {
+            perror("Failed to allocate game records");
+            result->recordCount = 0;
+            return false;
+        }
+    }
+
+    for (unsigned long long i = 0; i < result->recordCount; i++)
+    {
+        GameRecord *record = &result->records[i];
+        unsigned int turns, rounds;
+        in = getU64(in, &record->gameIndex);
+        record->winner = (*in == 0xFF) ? NO_WINNER : *in;
+        in++;
+        record->outcome = *in < OUTCOME_COUNT ? (GameOutcome)*in : OUTCOME_TURN_CAP;
+        in++;
+        in = getU32(in, &turns);
+        in = getU32(in, &rounds);
+        record->turns = (int)turns;
+        record->rounds = (int)rounds;
+    }
+
+    return true;
+}
+
+bool writeSimResult(const char *path, const SimResult *result)
+{
+    unsigned char *buffer;
+    size_t length = encodeSimResult(result, &buffer);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        perror(path);
+        free(buffer);
+        return false;
+    }
+
+    bool written = fwrite(buffer, 1, length, file) == length;
+    if (fclose(file) != 0)
+    {
+        written = false;
+    }
+    if (!written)
+    {
+        perror(path);
+    }
+    free(buffer);
+    return written;
+}
+
+bool readSimResult(const char *path, SimResult *result)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    size_t capacity = 4096;
+    size_t length = 0;
+    unsigned char *buffer = malloc(capacity);
+    size_t count;
+    while (buffer != NULL && (count = fread(buffer + length, 1, capacity - length, file)) > 0)
+    {
+        length += count;
+        if (length == capacity)
+        {
+            capacity *= 2;
+            unsigned char *larger = realloc(buffer, capacity);
+            if (larger == NULL)
+            {
+                free(buffer);
+            }
+            buffer = larger;
+        }
+    }
+    fclose(file);
+
+    if (buffer == NULL)
+    {
+        perror("Failed to allocate result buffer");
+        return false;
+    }
+
+    bool decoded = decodeSimResult(buffer, length, result);
+    free(buffer);
+    return decoded;
+}
+
+void printSimResult(const SimResult *result)
+{
+    const SimStats *stats = &result->stats;
+    double games = stats->games > 0 ? (double)stats->games : 1.0;
+    double meanTurns = stats->totalTurns / games;
+    double turnVariance = stats->totalTurnsSquared / games - meanTurns * meanTurns;
+
+    if (stats->games == 0)
+    {
+        printf("Study seed %llu, no games\n", result->config.studySeed);
+        return;
+    }
+
+    printf("Study seed %llu, games %llu-%llu (%llu games)\n", result->config.studySeed,
+           result->firstGame, result->firstGame + result->gameCount - 1, stats->games);
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        printf("%-7s wins %10llu (%5.2f%%), captures %llu\n", getColorName(i),
+               stats->wins[i], 100.0 * stats->wins[i] / games, stats->captures[i]);
+    }
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        if (!isDefaultSeatStrategy(i, result->config.strategies[i]))
+        {
+            printf("%-7s plays %s\n", getColorName(i), result->config.strategies[i]);
+        }
+    }
+    printf("Finished %llu, stopped: turn cap %llu, stalled %llu, cycle %llu\n", stats->outcomes[OUTCOME_FINISHED],
+           stats->outcomes[OUTCOME_TURN_CAP], stats->outcomes[OUTCOME_STALLED], stats->outcomes[OUTCOME_CYCLE]);
+    printf("Turns per game: mean %.1f, stddev %.1f, min %llu, max %llu\n", meanTurns,
+           turnVariance > 0 ? sqrt(turnVariance) : 0.0,
+           stats->minTurns, stats->maxTurns);
+}
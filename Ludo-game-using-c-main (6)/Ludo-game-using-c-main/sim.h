@@ -0,0 +1,87 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "runaway.h"
+#include "strategy.h"
+#include <stddef.h>
+
+#define NO_WINNER -1
+
+// Encoded size of a SimConfig, as carried by result files and shard requests
+#define SIM_CONFIG_SIZE (8 * 6 + NUM_PLAYERS * STRATEGY_SPEC_SIZE)
+
+typedef struct
+{
+    unsigned long long studySeed;
+    RunawayLimits limits;
+    bool keepRecords;
+    char strategies[NUM_PLAYERS][STRATEGY_SPEC_SIZE]; // seat strategy specs the study is played with
+} SimConfig;
+
+typedef struct
+{
+    unsigned long long gameIndex;
+    int winner; // player index, or NO_WINNER when the game was stopped
+    GameOutcome outcome;
+    int turns;
+    int rounds;
+} GameRecord;
+
+// Plain sums, minimum and maximum only, so merging is exact and order free
+typedef struct
+{
+    unsigned long long games;
+    unsigned long long wins[NUM_PLAYERS];
+    unsigned long long outcomes[OUTCOME_COUNT];
+    unsigned long long totalTurns;
+    unsigned long long totalTurnsSquared;
+    unsigned long long captures[NUM_PLAYERS];
+    unsigned long long minTurns;
+    unsigned long long maxTurns;
+} SimStats;
+
+// Result of a range of games [firstGame, firstGame + gameCount) of one study
+typedef struct
+{
+    SimConfig config;
+    unsigned long long firstGame;
+    unsigned long long gameCount;
+    SimStats stats;
+    GameRecord *records; // sorted by gameIndex, NULL unless config.keepRecords
+    unsigned long long recordCount;
+} SimResult;
+
+void initSimConfig(SimConfig *config);
+// The study takes the seats' current strategies, and a process that plays
+// part of it puts them back in the seats first
+void recordSeatStrategies(SimConfig *config);
+bool applySeatStrategies(const SimConfig *config);
+
+// A game can be played in one go, or a turn at a time so that many games
+// can be kept in flight
+void startSimulatedGame(const SimConfig *config, RunawayDetector *detector, unsigned long long gameIndex,
+                        GameState *game, GameRecord *record);
+bool stepSimulatedGame(GameState *game, RunawayDetector *detector, GameRecord *record); // true once over
+void countCaptures(const GameState *game, int captures[NUM_PLAYERS]);
+void playSimulatedGame(const SimConfig *config, RunawayDetector *detector, unsigned long long gameIndex,
+                       GameRecord *record, int captures[NUM_PLAYERS]);
+void runSimulation(const SimConfig *config, unsigned long long firstGame, unsigned long long gameCount, SimResult *result);
+void addGameToStats(SimStats *stats, const GameRecord *record, const int captures[NUM_PLAYERS]);
+void mergeSimStats(SimStats *stats, const SimStats *other);
+bool mergeSimResults(SimResult *into, const SimResult *from);
+void freeSimResult(SimResult *result);
+
+unsigned char *putU64(unsigned char *out, unsigned long long value);
+unsigned char *putU32(unsigned char *out, unsigned int value);
+const unsigned char *getU64(const unsigned char *in, unsigned long long *value);
+const unsigned char *getU32(const unsigned char *in, unsigned int *value);
+unsigned char *encodeSimConfig(unsigned char *out, const SimConfig *config);
+const unsigned char *decodeSimConfig(const unsigned char *in, SimConfig *config);
+bool sameSimConfig(const SimConfig *left, const SimConfig *right);
+size_t encodeSimResult(const SimResult *result, unsigned char **buffer);
+bool decodeSimResult(const unsigned char *buffer, size_t length, SimResult *result);
+bool writeSimResult(const char *path, const SimResult *result);
+bool readSimResult(const char *path, SimResult *result);
+void printSimResult(const SimResult *result);
+
+#endif // SIM_H
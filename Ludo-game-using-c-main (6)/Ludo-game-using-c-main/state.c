@@ -0,0 +1,221 @@
+#include "state.h"
+#include <string.h>
+
+#define STATE_RECORD_VERSION 1
+
+// Piece flag bits in a state record
+#define FLAG_HOME 0x01
+#define FLAG_BASE 0x02
+#define FLAG_COUNTERCLOCKWISE 0x04
+#define FLAG_ENERGIZED 0x08
+#define FLAG_SICK 0x10
+#define FLAG_MOVE_AGAIN 0x20
+
+void serializeGameState(const GameState *game, unsigned char record[STATE_RECORD_SIZE])
+{
+    unsigned char *out = record;
+    *out++ = STATE_RECORD_VERSION;
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        for (int j = 0; j < PIECES_PER_PLAYER; j++)
+        {
+            const Piece *piece = &game->players[i].pieces[j];
+            *out++ = (unsigned char)(signed char)piece->position;
+            *out++ = (piece->isHome ? FLAG_HOME : 0) | (piece->isBase ? FLAG_BASE : 0) |
+                     (piece->direction == COUNTERCLOCKWISE ? FLAG_COUNTERCLOCKWISE : 0) |
+                     (piece->isEnergized ? FLAG_ENERGIZED : 0) | (piece->isSick ? FLAG_SICK : 0) |
+                     (piece->canMoveAgain ? FLAG_MOVE_AGAIN : 0);
+            *out++ = (unsigned char)piece->captures;
+            *out++ = (unsigned char)(piece->captures >> 8);
+            *out++ = (unsigned char)piece->briefingRoundsLeft;
+        }
+    }
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        *out++ = (unsigned char)(signed char)game->players[i].piecesInBase;
+        *out++ = (unsigned char)(signed char)game->players[i].piecesInHome;
+    }
+
+    *out++ = (unsigned char)(signed char)game->mysteryCell.position;
+    *out++ = (unsigned char)(signed char)game->mysteryCell.roundsLeft;
+    *out++ = (unsigned char)game->currentPlayerIndex;
+    for (int i = 0; i < 4; i++)
+    {
+        *out++ = (unsigned char)((unsigned int)game->roundCount >> (8 * i));
+    }
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        *out++ = (unsigned char)game->consecutiveSixesCount[i];
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        *out++ = (unsigned char)(game->rngState >> (8 * i));
+    }
+}
+
+bool deserializeGameState(const unsigned char record[STATE_RECORD_SIZE], GameState *game)
+{
+    const unsigned char *in = record;
+    if (*in++ != STATE_RECORD_VERSION)
+    {
+        return false;
+    }
+
+    memset(game, 0, sizeof(*game));
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        game->players[i].color = i;
+        for (int j = 0; j < PIECES_PER_PLAYER; j++)
+        {
+            Piece *piece = &game->players[i].pieces[j];
+            piece->id = j + 1;
+            piece->color = i;
+            piece->position = (signed char)*in++;
+            unsigned char flags = *in++;
+            piece->isHome = (flags & FLAG_HOME) != 0;
+            piece->isBase = (flags & FLAG_BASE) != 0;
+            piece->direction = (flags & FLAG_COUNTERCLOCKWISE) ? COUNTERCLOCKWISE : CLOCKWISE;
+            piece->isEnergized = (flags & FLAG_ENERGIZED) != 0;
+            piece->isSick = (flags & FLAG_SICK) != 0;
+            piece->canMoveAgain = (flags & FLAG_MOVE_AGAIN) != 0;
+            piece->captures = in[0] | (in[1] << 8);
+            in += 2;
+            piece->briefingRoundsLeft = *in++;
+        }
+    }
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        game->players[i].piecesInBase = (signed char)*in++;
+        game->players[i].piecesInHome = (signed char)*in++;
+    }
+
+    game->mysteryCell.position = (signed char)*in++;
+    game->mysteryCell.roundsLeft = (signed char)*in++;
+    game->currentPlayerIndex = *in++;
+    unsigned int roundCount = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        roundCount |= (unsigned int)*in++ << (8 * i);
+    }
+    game->roundCount = (int)roundCount;
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        game->consecutiveSixesCount[i] = *in++;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        game->rngState |= (unsigned long long)*in++ << (8 * i);
+    }
+
+    return game->currentPlayerIndex < NUM_PLAYERS;
+}
+
+#define COMPARE_FIELD(field, ...)                                                                  \
+    if (left->field != right->field)                                                               \
+    {                                                                                              \
+        differences++;                                                                             \
+        if (out != NULL)                                                                           \
+        {                                                                                          \
+            fprintf(out, __VA_ARGS__);                                                             \
+            fprintf(out, ": %lld != %lld\n", (long long)left->field, (long long)right->field);     \
+        }                                                                                          \
+    }
+
+int diffGameStates(const GameState *left, const GameState *right, FILE *out)
+{
+    int differences = 0;
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        COMPARE_FIELD(players[i].color, "players[%d].color", i);
+        COMPARE_FIELD(players[i].piecesInBase, "players[%d].piecesInBase", i);
+        COMPARE_FIELD(players[i].piecesInHome, "players[%d].piecesInHome", i);
+
+        for (int j = 0; j < PIECES_PER_PLAYER; j++)
+        {
+            COMPARE_FIELD(players[i].pieces[j].id, "players[%d].pieces[%d].id", i, j);
+            COMPARE_FIELD(players[i].pieces[j].color, "players[%d].pieces[%d].color", i, j);
+            COMPARE_FIELD(players[i].pieces[j].position, "players[%d].pieces[%d].position", i, j);
+            COMPARE_FIELD(players[i].pieces[j].isHome, "players[%d].pieces[%d].isHome", i, j);
+            COMPARE_FIELD(players[i].pieces[j].isBase, "players[%d].pieces[%d].isBase", i, j);
+            COMPARE_FIELD(players[i].pieces[j].direction, "players[%d].pieces[%d].direction", i, j);
+            COMPARE_FIELD(players[i].pieces[j].captures, "players[%d].pieces[%d].captures", i, j);
+            COMPARE_FIELD(players[i].pieces[j].isEnergized, "players[%d].pieces[%d].isEnergized", i, j);
+            COMPARE_FIELD(players[i].pieces[j].isSick, "players[%d].pieces[%d].isSick", i, j);
+            COMPARE_FIELD(players[i].pieces[j].briefingRoundsLeft, "players[%d].pieces[%d].briefingRoundsLeft", i, j);
+            COMPARE_FIELD(players[i].pieces[j].canMoveAgain, "players[%d].pieces[%d].canMoveAgain", i, j);
+        }
+    }
+
+    COMPARE_FIELD(mysteryCell.position, "mysteryCell.position");
+    COMPARE_FIELD(mysteryCell.roundsLeft, "mysteryCell.roundsLeft");
+    COMPARE_FIELD(currentPlayerIndex, "currentPlayerIndex");
+    COMPARE_FIELD(roundCount, "roundCount");
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        COMPARE_FIELD(consecutiveSixesCount[i], "consecutiveSixesCount[%d]", i);
+    }
+
+    if (left->rngState != right->rngState)
+    {
+        differences++;
+        if (out != NULL)
+        {
+            fprintf(out, "rngState: %llu != %llu (random stream diverged)\n", left->rngState, right->rngState);
+        }
+    }
+
+    return differences;
+}
+
+void dumpGameState(const GameState *game, FILE *out)
+{
+    fprintf(out, "Round %d, %s to play, mystery cell %d (%d rounds), rng %llu\n", game->roundCount,
+            getColorName(game->players[game->currentPlayerIndex].color), game->mysteryCell.position,
+            game->mysteryCell.roundsLeft, game->rngState);
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        const Player *player = &game->players[i];
+        fprintf(out, "  %-7s base %d home %d sixes %d |", getColorName(player->color), player->piecesInBase,
+                player->piecesInHome, game->consecutiveSixesCount[i]);
+
+        for (int j = 0; j < PIECES_PER_PLAYER; j++)
+        {
+            const Piece *piece = &player->pieces[j];
+            if (piece->isBase)
+            {
+                fprintf(out, " %d:base", piece->id);
+            }
+            else if (piece->isHome)
+            {
+                fprintf(out, " %d:home", piece->id);
+            }
+            else
+            {
+                fprintf(out, " %d:@%d%s", piece->id, piece->position, piece->direction == COUNTERCLOCKWISE ? "ccw" : "");
+            }
+            if (piece->captures > 0)
+            {
+                fprintf(out, "/c%d", piece->captures);
+            }
+            if (piece->briefingRoundsLeft > 0)
+            {
+                fprintf(out, "/b%d", piece->briefingRoundsLeft);
+            }
+            if (piece->isEnergized)
+            {
+                fprintf(out, "/energized");
+            }
+            if (piece->isSick)
+            {
+                fprintf(out, "/sick");
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include "types.h"
+#include <stdio.h>
+
+// Fixed-size, byte-order independent image of a GameState (generator included)
+#define STATE_RECORD_SIZE 108
+
+void serializeGameState(const GameState *game, unsigned char record[STATE_RECORD_SIZE]);
+bool deserializeGameState(const unsigned char record[STATE_RECORD_SIZE], GameState *game);
+
+// Compares every field of two states. When out is not NULL each difference
+// is written to it as "field: left != right". Returns the number of differences.
+int diffGameStates(const GameState *left, const GameState *right, FILE *out);
+void dumpGameState(const GameState *game, FILE *out);
+
+#endif // STATE_H
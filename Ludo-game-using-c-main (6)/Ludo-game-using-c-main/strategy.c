@@ -0,0 +1,435 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "strategy.h"
+#include <ctype.h>
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool isBlockadeCell(const TurnFeatures *features, int position)
+{
+    return position >= 0 && position < BOARD_SIZE && (features->blockadeCells >> position & 1) != 0;
+}
+
+#define TRACK_MASK ((1ULL << BOARD_SIZE) - 1)
+
+// Turns the track so that cell position becomes bit 0
+static unsigned long long rotateCells(unsigned long long cells, int position)
+{
+    return ((cells >> position) | (cells << (BOARD_SIZE - position))) & TRACK_MASK;
+}
+
+// The board goes into three 52-bit cell masks in one pass over the pieces.
+// Per-piece features then come from a few bit operations on those masks
+// rather than from rescanning every piece on the board for every piece.
+void buildTurnFeatures(const GameState *game, int playerIndex, int diceRoll, TurnFeatures *features)
+{
+    const Player *player = &game->players[playerIndex];
+    unsigned long long occupied = 0;
+    unsigned long long opponents = 0;
+
+    features->playerIndex = playerIndex;
+    features->diceRoll = diceRoll;
+    features->startingPosition = (playerIndex * 13 + 2) % BOARD_SIZE;
+    features->firstBasePiece = NO_PIECE;
+    features->blockadeCells = 0;
+
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        unsigned long long playerCells = 0;
+        for (int j = 0; j < PIECES_PER_PLAYER; j++)
+        {
+            // Branch-free: whether a piece is on the track is close to random
+            const Piece *piece = &game->players[i].pieces[j];
+            unsigned long long onTrack = !piece->isBase & !piece->isHome & ((unsigned int)piece->position < BOARD_SIZE);
+            unsigned long long cell = onTrack << (piece->position & 63);
+            features->blockadeCells |= occupied & cell;
+            occupied |= cell;
+            playerCells |= cell;
+        }
+        if (i != playerIndex)
+        {
+            opponents |= playerCells;
+        }
+    }
+
+    // Bit BOARD_SIZE of a rotated mask is always clear, so a roll that cannot
+    // reach anybody tests that bit
+    bool validRoll = diceRoll > 0 && diceRoll <= BOARD_SIZE / 2;
+    int captureAhead = validRoll ? diceRoll : BOARD_SIZE;
+    int captureBehind = validRoll ? BOARD_SIZE - diceRoll : BOARD_SIZE;
+    int blockStep = diceRoll >= 0 ? diceRoll % BOARD_SIZE : 0;
+    unsigned long long blockTargets = occupied & ~features->blockadeCells;
+
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        const Piece *piece = &player->pieces[i];
+        bool onBoard = !piece->isBase && !piece->isHome;
+        bool onTrack = onBoard && (unsigned int)piece->position < BOARD_SIZE;
+        int position = onTrack ? piece->position : 0;
+
+        features->onBoard[i] = onBoard;
+        if (piece->isBase && features->firstBasePiece == NO_PIECE)
+        {
+            features->firstBasePiece = i;
+        }
+
+        // Nearest opponent ahead is the lowest bit, nearest behind the highest
+        unsigned long long ahead = onTrack ? rotateCells(opponents, position) : 0;
+        int forward = __builtin_ctzll(ahead | 1ULL << 63);
+        int backward = BOARD_SIZE - (63 - __builtin_clzll(ahead | 1));
+        int nearest = forward < backward ? forward : backward;
+        features->nearestOpponent[i] = ahead != 0 ? nearest : BOARD_SIZE + 1;
+        features->canCapture[i] = (((ahead >> captureAhead) | (ahead >> captureBehind)) & 1) != 0;
+
+        features->homeDistance[i] = onTrack ? distanceBetweenPieces(position, features->startingPosition) : BOARD_SIZE + 1;
+
+        // Same answer as canMoveBlock(): the target cell must hold exactly one
+        // other piece, so the move makes a block without joining one
+        int target = position + blockStep < BOARD_SIZE ? position + blockStep : position + blockStep - BOARD_SIZE;
+        features->canMoveBlock[i] = onTrack && ((blockTargets >> target) & 1) != 0;
+    }
+}
+
+static StrategyMove makeMove(StrategyAction action, int piece, const char *note)
+{
+    StrategyMove move = {action, piece, note, NULL};
+    return move;
+}
+
+static StrategyMove withAside(StrategyMove move, const char *aside)
+{
+    move.aside = aside;
+    return move;
+}
+
+static StrategyMove pass(void)
+{
+    return makeMove(ACTION_PASS, NO_PIECE, NULL);
+}
+
+// Picks one of the pieces on the board at random, or NO_PIECE without
+// drawing from the generator when there are none
+static int randomBoardPiece(GameState *game, const TurnFeatures *features)
+{
+    int movablePieces[PIECES_PER_PLAYER];
+    int numMovablePieces = 0;
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        if (features->onBoard[i])
+        {
+            movablePieces[numMovablePieces++] = i;
+        }
+    }
+    if (numMovablePieces > 0)
+    {
+        return movablePieces[randomInt(game, numMovablePieces)];
+    }
+    return NO_PIECE;
+}
+
+static bool canLeaveBase(const GameState *game, const TurnFeatures *features)
+{
+    return features->diceRoll == 6 && game->players[features->playerIndex].piecesInBase > 0 &&
+           features->firstBasePiece != NO_PIECE;
+}
+
+// ---------------------------------------------------------------------------
+// Built-in strategies, one per colour as the game was first written
+
+static StrategyMove decideRed(GameState *game, const TurnFeatures *features)
+{
+    // 1. Prioritize capturing
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        if (features->onBoard[i] && features->canCapture[i])
+        {
+            return makeMove(ACTION_MOVE, i, "RED player is moving to capture!\n");
+        }
+    }
+
+    // 2. Move a piece from the base
+    if (canLeaveBase(game, features))
+    {
+        return makeMove(ACTION_MOVE, features->firstBasePiece, "RED player moves a piece from base to X.\n");
+    }
+
+    // 3. Move another movable piece
+    int piece = randomBoardPiece(game, features);
+    if (piece != NO_PIECE)
+    {
+        return makeMove(ACTION_MOVE, piece, "RED player moves a piece already on the board.\n");
+    }
+    return pass();
+}
+
+static StrategyMove decideGreen(GameState *game, const TurnFeatures *features)
+{
+    const Player *player = &game->players[features->playerIndex];
+    const char *aside = NULL;
+
+    // 1. Move from the base to X, unless that would crowd a block on X
+    if (features->diceRoll == 6 && player->piecesInBase > 0)
+    {
+        if (!(isBlockadeCell(features, features->startingPosition) && player->piecesInBase <= 2))
+        {
+            if (features->firstBasePiece != NO_PIECE)
+            {
+                return makeMove(ACTION_MOVE, features->firstBasePiece, "GREEN player moves a piece from the base to X.\n");
+            }
+        }
+        else
+        {
+            aside = "GREEN player chooses to keep a piece in the base to avoid a potential block.\n";
+        }
+    }
+
+    // 2. Attempt to create or maintain a block
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        if (features->canMoveBlock[i])
+        {
+            return withAside(makeMove(ACTION_MOVE_BLOCK, i, NULL), aside);
+        }
+    }
+
+    // 3. Move another piece towards home
+    int piece = randomBoardPiece(game, features);
+    if (piece != NO_PIECE)
+    {
+        return withAside(makeMove(ACTION_MOVE, piece, "GREEN player moves a piece already on the board.\n"), aside);
+    }
+    return withAside(pass(), aside);
+}
+
+static StrategyMove decideYellow(GameState *game, const TurnFeatures *features)
+{
+    const Player *player = &game->players[features->playerIndex];
+
+    // 1. Move from the base to X
+    if (canLeaveBase(game, features))
+    {
+        return makeMove(ACTION_MOVE, features->firstBasePiece, "YELLOW player moves a piece from the base to X.\n");
+    }
+
+    // 2. Capture with a piece that still needs one to enter the home path
+    // (the last such piece, as the game always chose)
+    int pieceToMove = NO_PIECE;
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        if (features->onBoard[i] && player->pieces[i].captures < 1 && features->canCapture[i])
+        {
+            pieceToMove = i;
+        }
+    }
+    if (pieceToMove != NO_PIECE)
+    {
+        return makeMove(ACTION_MOVE, pieceToMove, "YELLOW player is moving to capture to enter the home path!\n");
+    }
+
+    // 3. Move the piece closest to home
+    int closestToHomeDistance = BOARD_SIZE + 1;
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        if (features->onBoard[i] && features->homeDistance[i] < closestToHomeDistance)
+        {
+            closestToHomeDistance = features->homeDistance[i];
+            pieceToMove = i;
+        }
+    }
+    if (pieceToMove != NO_PIECE)
+    {
+        return makeMove(ACTION_MOVE, pieceToMove, NULL);
+    }
+    return pass();
+}
+
+static StrategyMove decideBlue(GameState *game, const TurnFeatures *features)
+{
+    const Player *player = &game->players[features->playerIndex];
+
+    // 1. Move the piece that has been on the board the longest
+    int pieceToMove = NO_PIECE;
+    int oldestRound = game->roundCount;
+    for (int i = 0; i < PIECES_PER_PLAYER; i++)
+    {
+        const Piece *piece = &player->pieces[i];
+        if (features->onBoard[i] && piece->position >= 0 && piece->position < BOARD_SIZE)
+        {
+            int roundsOnBoard = game->roundCount - (piece->briefingRoundsLeft + 1); // Approximation
+            if (roundsOnBoard < oldestRound)
+            {
+                oldestRound = roundsOnBoard;
+                pieceToMove = i;
+            }
+        }
+    }
+    if (pieceToMove != NO_PIECE)
+    {
+        return makeMove(ACTION_MOVE, pieceToMove, "BLUE player moves the oldest piece on the board.\n");
+    }
+
+    // 2. If no pieces are on the board, try to move a piece from the base
+    if (canLeaveBase(game, features))
+    {
+        return makeMove(ACTION_MOVE, features->firstBasePiece, "BLUE player moves a piece from the base to X.\n");
+    }
+
+    // 3. Move another piece at random
+    pieceToMove = randomBoardPiece(game, features);
+    if (pieceToMove != NO_PIECE)
+    {
+        return makeMove(ACTION_MOVE, pieceToMove, "BLUE player moves a piece randomly.\n");
+    }
+    return pass();
+}
+
+// Indexed by PlayerColor for the default seating
+static const Strategy builtinStrategies[] = {
+    {"yellow", "leaves the base on six, captures to unlock home, else advances the piece nearest home", decideYellow},
+    {"blue", "moves the longest-serving piece, else leaves the base, else a random piece", decideBlue},
+    {"red", "captures first, else leaves the base on six, else a random piece", decideRed},
+    {"green", "leaves the base unless X is blocked, else builds blocks, else a random piece", decideGreen},
+};
+
+#define BUILTIN_COUNT (int)(sizeof(builtinStrategies) / sizeof(builtinStrategies[0]))
+
+static const Strategy *seatStrategies[NUM_PLAYERS];
+static char seatSpecs[NUM_PLAYERS][STRATEGY_SPEC_SIZE];
+
+const Strategy *findStrategy(const char *name)
+{
+    for (int i = 0; i < BUILTIN_COUNT; i++)
+    {
+        if (strcmp(builtinStrategies[i].name, name) == 0)
+        {
+            return &builtinStrategies[i];
+        }
+    }
+    return NULL;
+}
+
+void listStrategies(FILE *out)
+{
+    for (int i = 0; i < BUILTIN_COUNT; i++)
+    {
+        fprintf(out, "  %-15s %s\n", builtinStrategies[i].name, builtinStrategies[i].description);
+    }
+}
+
+const Strategy *getSeatStrategy(int playerIndex)
+{
+    if (seatStrategies[playerIndex] == NULL)
+    {
+        return &builtinStrategies[playerIndex];
+    }
+    return seatStrategies[playerIndex];
+}
+
+const char *getSeatStrategySpec(int playerIndex)
+{
+    return seatStrategies[playerIndex] == NULL ? builtinStrategies[playerIndex].name : seatSpecs[playerIndex];
+}
+
+bool isDefaultSeatStrategy(int playerIndex, const char *spec)
+{
+    return strcmp(spec, builtinStrategies[playerIndex].name) == 0;
+}
+
+static int parseSeat(const char *seat, size_t length)
+{
+    if (length == 1 && seat[0] >= '0' && seat[0] < '0' + NUM_PLAYERS)
+    {
+        return seat[0] - '0';
+    }
+    for (int i = 0; i < NUM_PLAYERS; i++)
+    {
+        const char *color = getColorName(i);
+        size_t k = 0;
+        while (k < length && color[k] != '\0' && tolower((unsigned char)seat[k]) == tolower((unsigned char)color[k]))
+        {
+            k++;
+        }
+        if (k == length && color[k] == '\0')
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// The library stays loaded for the life of the process. It resolves engine
+// functions such as randomInt against the program, which is why the program
+// is linked with -rdynamic.
+static const Strategy *loadStrategy(const char *spec)
+{
+    char path[4096];
+    const char *symbol = DEFAULT_STRATEGY_SYMBOL;
+    snprintf(path, sizeof(path), "%s", spec);
+
+    char *colon = strrchr(path, ':');
+    if (colon != NULL && strchr(colon, '/') == NULL)
+    {
+        *colon = '\0';
+        symbol = colon + 1;
+    }
+
+    void *library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (library == NULL)
+    {
+        fprintf(stderr, "Cannot load strategy library: %s\n", dlerror());
+        return NULL;
+    }
+    const Strategy *strategy = dlsym(library, symbol);
+    if (strategy == NULL || strategy->decide == NULL)
+    {
+        fprintf(stderr, "%s does not export a strategy named %s.\n", path, symbol);
+        dlclose(library);
+        return NULL;
+    }
+    return strategy;
+}
+
+bool setSeatStrategy(int playerIndex, const char *spec)
+{
+    if (strcmp(spec, getSeatStrategySpec(playerIndex)) == 0)
+    {
+        return true;
+    }
+    if (strlen(spec) >= STRATEGY_SPEC_SIZE)
+    {
+        fprintf(stderr, "Strategy '%s' is longer than %d characters.\n", spec, STRATEGY_SPEC_SIZE - 1);
+        return false;
+    }
+
+    const Strategy *strategy = findStrategy(spec);
+    if (strategy == NULL && strchr(spec, '/') == NULL && strstr(spec, ".so") == NULL)
+    {
+        fprintf(stderr, "Unknown strategy '%s'.\n", spec);
+        return false;
+    }
+    if (strategy == NULL)
+    {
+        strategy = loadStrategy(spec);
+    }
+    if (strategy == NULL)
+    {
+        return false;
+    }
+
+    seatStrategies[playerIndex] = strategy;
+    strcpy(seatSpecs[playerIndex], spec);
+    return true;
+}
+
+bool assignStrategy(const char *spec)
+{
+    const char *equals = strchr(spec, '=');
+    int seat = equals != NULL ? parseSeat(spec, (size_t)(equals - spec)) : -1;
+    if (seat < 0)
+    {
+        fprintf(stderr, "Bad strategy assignment '%s': expected SEAT=NAME.\n", spec);
+        return false;
+    }
+    return setSeatStrategy(seat, equals + 1);
+}
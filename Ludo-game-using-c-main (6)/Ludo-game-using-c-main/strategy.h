@@ -0,0 +1,77 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include "types.h"
+#include <stdio.h>
+
+#define NO_PIECE -1
+
+// Symbol looked up in a strategy library when the spec names none
+#define DEFAULT_STRATEGY_SYMBOL "ludoStrategy"
+
+// Board scans every strategy would otherwise repeat, built once per decision
+// by implementPlayerBehaviors
+typedef struct
+{
+    int playerIndex;
+    int diceRoll;
+    int startingPosition;                       // where this player's pieces enter and leave the track
+    int firstBasePiece;                         // lowest piece waiting in the base, or NO_PIECE
+    bool onBoard[PIECES_PER_PLAYER];            // neither in the base nor home
+    int nearestOpponent[PIECES_PER_PLAYER];     // shortest distance to an opponent piece, BOARD_SIZE + 1 if none
+    bool canCapture[PIECES_PER_PLAYER];         // an opponent piece is exactly diceRoll away
+    int homeDistance[PIECES_PER_PLAYER];        // distance to startingPosition
+    bool canMoveBlock[PIECES_PER_PLAYER];       // canMoveBlock() for diceRoll
+    unsigned long long blockadeCells;           // bit per cell holding two or more pieces
+} TurnFeatures;
+
+typedef enum
+{
+    ACTION_PASS,
+    ACTION_MOVE,      // movePiece
+    ACTION_MOVE_BLOCK // moveBlock
+} StrategyAction;
+
+typedef struct
+{
+    StrategyAction action;
+    int piece;
+    const char *note;  // narrated after the move, may be NULL
+    const char *aside; // narrated before the move, or instead of it on a pass; may be NULL
+} StrategyMove;
+
+// A strategy only decides; implementPlayerBehaviors carries the move out and
+// narrates its note and aside.
+// decide may draw from the game's generator, and a strategy that does must
+// always draw in the same order for the same position.
+typedef struct
+{
+    const char *name;
+    const char *description;
+    StrategyMove (*decide)(GameState *game, const TurnFeatures *features);
+} Strategy;
+
+bool isBlockadeCell(const TurnFeatures *features, int position);
+void buildTurnFeatures(const GameState *game, int playerIndex, int diceRoll, TurnFeatures *features);
+
+const Strategy *findStrategy(const char *name);
+void listStrategies(FILE *out);
+
+// Room for a strategy spec, terminator included: a built-in name or
+// path.so[:symbol]. Studies record every seat's spec so that workers and
+// merges play and combine the same strategies.
+#define STRATEGY_SPEC_SIZE 256
+
+// Seats start with the strategy of their colour
+const Strategy *getSeatStrategy(int playerIndex);
+const char *getSeatStrategySpec(int playerIndex);
+bool isDefaultSeatStrategy(int playerIndex, const char *spec);
+// Loads the strategy a spec names into the seat; a spec the seat already
+// has is not loaded again
+bool setSeatStrategy(int playerIndex, const char *spec);
+
+// Parses SEAT=NAME, where SEAT is a colour or a seat number and NAME is a
+// built-in strategy or a shared object, path.so[:symbol], exporting a Strategy
+bool assignStrategy(const char *spec);
+
+#endif // STRATEGY_H
@@ -58,7 +58,37 @@ typedef struct
     int currentPlayerIndex;
     int roundCount;
     int consecutiveSixesCount[NUM_PLAYERS];
+    unsigned long long rngState;
 } GameState;
+extern bool gameLogEnabled;
+void gameLog(const char *format, ...);
+// Only the lockstep harness's mutant engine turns this off
+extern bool kotuwaRecursionEnabled;
+
+// The draws importance sampling may take over. Without a hook they come
+// from randomInt like every other draw.
+typedef enum
+{
+    DRAW_TURN_ROLL,          // playerIndex, pieceIndex -1
+    DRAW_BONUS_ROLL,         // the capturing piece
+    DRAW_MYSTERY_DESTINATION // the piece on the mystery cell
+} DrawKind;
+
+// Returns an outcome in [0, outcomes), drawn from the game's generator
+typedef int (*DrawHook)(void *context, GameState *game, DrawKind kind, int playerIndex, int pieceIndex,
+                        int outcomes);
+void setDrawHook(DrawHook hook, void *context);
+const char *getColorName(PlayerColor color);
+void initializeGame(GameState *game);
+void seedGame(GameState *game, unsigned long long seed);
+int randomInt(GameState *game, int bound);
+int rollDice(GameState *game);
+void chooseFirstPlayer(GameState *game);
+void movePiece(GameState *game, int playerIndex, int pieceIndex, int steps);
+int rollForTurn(GameState *game);
+int playTurn(GameState *game);
+void advanceTurn(GameState *game);
+bool checkForWin(GameState *game, int playerIndex);
 void implementPlayerBehaviors(GameState *game, int diceRoll, int playerIndex);
 // Function prototype for breakBlockade:
 void breakBlockade(GameState *game, int playerIndex);